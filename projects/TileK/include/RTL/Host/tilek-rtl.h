@@ -50,5 +50,17 @@ void klt_user_wait(struct klt_kernel_t * kernel);
 
 int klt_user_get_tile_length(struct klt_kernel_t * kernel, unsigned long kind, unsigned long param);
 
+#if defined(TILEK_THREADS)
+#include <stddef.h>
+
+// Runs task(tid, num_threads, arg) for tid in [0, num_threads) on the worker pool used by the kernels.
+void tilek_parallel(int num_threads, void (*task)(int tid, int num_threads, void * arg), void * arg);
+
+// Allocates a zeroed array whose pages are first touched by the pool's threads: the i-th of num_threads
+// blocks is touched by thread i, which places it on that thread's NUMA node.  Use the same number of
+// threads as the kernels (num_threads <= 0 for the default).  Release with free().
+void * tilek_first_touch_alloc(size_t size, int num_threads);
+#endif
+
 #endif /* __TILEK_RTL_KERNEL_H__ */
 
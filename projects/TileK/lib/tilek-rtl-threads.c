@@ -1,4 +1,8 @@
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE // pthread_setaffinity_np
+#endif
+
 #include "RTL/Host/tilek-rtl.h"
 
 #include "KLT/RTL/kernel.h"
@@ -8,101 +12,377 @@
 #include "KLT/RTL/context.h"
 
 #include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
 
 #include <stdlib.h>
 #include <string.h>
 
 #include <assert.h>
 
+// Kind of the tiles distributed over the threads (tile(thread))
+enum { e_tile_thread = 2 };
+
+// Number of times a worker polls for a launch before sleeping on the pool's condition variable,
+// and a thread polls the barrier before yielding the processor
+#define TILEK_SPIN_COUNT 100000
+
+static int tilek_num_cpus() {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+}
+
+// Threads for kernels that have thread tiles: TILEK_NUM_THREADS or one per processor
+static int tilek_default_num_threads() {
+  const char * env = getenv("TILEK_NUM_THREADS");
+  if (env != NULL && atoi(env) > 0)
+    return atoi(env);
+  return tilek_num_cpus();
+}
+
+static int tilek_has_thread_tile(struct klt_loop_container_t * loop) {
+  int i, j;
+  for (i = 0; i < loop->num_loops; i++)
+    for (j = 0; j < loop->loop_desc[i].num_tiles; j++)
+      if ((int)loop->loop_desc[i].tile_desc[j].kind == e_tile_thread)
+        return 1;
+  return 0;
+}
+
+// Without thread tiles every thread would execute the whole kernel, so one thread is used.
+// The num_threads clause overrides this after the kernel is built.
 struct klt_user_config_t * klt_user_build_config(struct klt_kernel_desc_t * desc)  {
   struct klt_user_config_t * config = malloc(sizeof(struct klt_user_config_t));
-    config->num_threads = 1;
+  int has_thread_tile = 0;
+  int i, j;
+  for (i = 0; i < desc->num_versions; i++)
+    for (j = 0; j < desc->versions[i].num_subkernels; j++)
+      has_thread_tile = has_thread_tile || tilek_has_thread_tile(&(desc->versions[i].subkernels[j].loop));
+  config->num_threads = has_thread_tile ? tilek_default_num_threads() : 1;
   return config;
 }
 
-struct tilek_worker_args_t {
+/*
+ * Persistent worker pool
+ *
+ * Workers are created on the first launch that needs them and then wait for
+ * subsequent launches; the launching thread executes thread 0 itself.  Each
+ * worker is pinned to a processor (unless TILEK_PIN_THREADS=0), which also
+ * makes first-touch placement by tilek_first_touch_alloc effective on NUMA systems.
+ *
+ * A launch writes the subkernel to the pool and bumps the generation of the
+ * workers taking part in it; workers poll their generation for a while and
+ * then sleep on a condition variable.  The end of the launch is a
+ * sense-reversing barrier between the participants.
+ */
+
+struct tilek_barrier_t {
+  volatile int count;
+  volatile int sense;
+  int size;
+};
+
+struct tilek_worker_t {
   int tid;
-  struct klt_kernel_t * kernel;
+  pthread_t thread;
+  volatile unsigned long generation;  // bumped by the launching thread for each launch this worker takes part in
+};
+
+struct tilek_pool_t {
+  int num_workers;                    // workers created (threads 1 to num_workers)
+  struct tilek_worker_t ** workers;
+  volatile int quit;
+
+  pthread_mutex_t mutex;              // for the sleeping workers
+  pthread_cond_t cond;
+  volatile int num_sleeping;
+
+  pthread_mutex_t launch_mutex;       // one launch at a time
+
+  int spin_count;                     // no polling if there are more threads than processors
+
+  // current launch
   struct klt_subkernel_desc_t * subkernel;
   void ** local_param;
   void ** local_data;
+  int max_params;
+  int max_data;
   struct klt_loop_context_t * klt_loop_context;
   struct klt_data_context_t * klt_data_context;
+  void (*task)(int tid, int num_threads, void * arg);   // used instead of the subkernel if not NULL
+  void * task_arg;
+  int num_threads;
+
+  struct tilek_barrier_t barrier;
 };
 
+static struct tilek_pool_t tilek_pool = {
+  0, NULL, 0,
+  PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0,
+  PTHREAD_MUTEX_INITIALIZER,
+  0,
+  NULL, NULL, NULL, 0, 0, NULL, NULL, NULL, NULL, 0,
+  { 0, 0, 0 }
+};
+
+// Set while the calling thread runs part of a launch. A launch from inside a launch would wait forever on
+// launch_mutex (or on the barrier, for the workers), so it is run inline by the calling thread instead.
+static __thread int tilek_in_launch = 0;
+
+static void tilek_cpu_relax() {
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__ ("pause");
+#endif
+}
+
+static void tilek_barrier_wait(struct tilek_barrier_t * barrier) {
+  // The sense can only flip once all participants arrived, so it can be read on arrival.
+  int local_sense = !barrier->sense;
+  if (__sync_sub_and_fetch(&barrier->count, 1) == 0) {
+    barrier->count = barrier->size;
+    __sync_synchronize();
+    barrier->sense = local_sense;
+  }
+  else {
+    int spin = 0;
+    while (barrier->sense != local_sense) {
+      if (spin < tilek_pool.spin_count) {
+        tilek_cpu_relax();
+        spin++;
+      }
+      else sched_yield();
+    }
+  }
+  __sync_synchronize();
+}
+
+static void tilek_run(int tid) {
+  struct tilek_pool_t * pool = &tilek_pool;
+  tilek_in_launch = 1;
+  if (pool->task != NULL)
+    (*pool->task)(tid, pool->num_threads, pool->task_arg);
+  else
+    (*pool->subkernel->config->kernel_ptr)(tid, pool->local_param, pool->local_data, pool->klt_loop_context, pool->klt_data_context);
+  tilek_in_launch = 0;
+}
+
+static void tilek_pin(pthread_t thread, int cpu) {
+#if defined(__linux__)
+  const char * env = getenv("TILEK_PIN_THREADS");
+  if (env != NULL && atoi(env) == 0)
+    return;
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu % tilek_num_cpus(), &cpuset);
+  pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+#endif
+}
+
 void * tilek_worker(void * args_) {
-  struct tilek_worker_args_t * args = (struct tilek_worker_args_t *)args_;
+  struct tilek_worker_t * worker = (struct tilek_worker_t *)args_;
+  struct tilek_pool_t * pool = &tilek_pool;
+  unsigned long generation = 0;
 
-  (*args->subkernel->config->kernel_ptr)(args->tid, args->local_param, args->local_data, args->klt_loop_context, args->klt_data_context);
+  while (1) {
+    int spin = 0;
+    while (worker->generation == generation && !pool->quit && spin < pool->spin_count) {
+      tilek_cpu_relax();
+      spin++;
+    }
+    if (worker->generation == generation && !pool->quit) {
+      pthread_mutex_lock(&pool->mutex);
+      // full barrier: either the launch sees this worker sleeping or this worker sees the launch
+      __sync_fetch_and_add(&pool->num_sleeping, 1);
+      while (worker->generation == generation && !pool->quit)
+        pthread_cond_wait(&pool->cond, &pool->mutex);
+      __sync_fetch_and_sub(&pool->num_sleeping, 1);
+      pthread_mutex_unlock(&pool->mutex);
+    }
+    if (worker->generation == generation)
+      break; // quit
+
+    generation = worker->generation;
+    __sync_synchronize();
+    tilek_run(worker->tid);
+    tilek_barrier_wait(&pool->barrier);
+  }
 
   pthread_exit(NULL);
 }
 
-size_t num_threads;
-pthread_t * threads;
-struct tilek_worker_args_t * threads_args;
+static void tilek_pool_shutdown() {
+  struct tilek_pool_t * pool = &tilek_pool;
+  int i;
 
-void klt_user_schedule(
-  struct klt_kernel_t * kernel, struct klt_subkernel_desc_t * subkernel,
-  struct klt_loop_context_t * klt_loop_context, struct klt_data_context_t * klt_data_context
-) {
-  assert(num_threads == 0);
-  assert(threads == 0);
-  assert(threads_args == 0);
-
-  void ** local_param = NULL;
-  void ** local_data = NULL;
-  {
-    int i;
-    local_param = (void **)malloc(subkernel->num_params * sizeof(void *));
-    local_data = (void **)malloc(subkernel->num_data * sizeof(void *));
-    for (i = 0; i < subkernel->num_params; i++)
-      local_param[i] = kernel->param[subkernel->param_ids[i]];
-    for (i = 0; i < subkernel->num_data; i++)
-      local_data[i] = kernel->data[subkernel->data_ids[i]].ptr;
+  pthread_mutex_lock(&pool->mutex);
+  pool->quit = 1;
+  pthread_cond_broadcast(&pool->cond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for (i = 0; i < pool->num_workers; i++) {
+    pthread_join(pool->workers[i]->thread, NULL);
+    free(pool->workers[i]);
   }
+  free(pool->workers);
+  free(pool->local_param);
+  free(pool->local_data);
+}
+
+static void tilek_pool_grow(int num_workers) {
+  struct tilek_pool_t * pool = &tilek_pool;
+  if (num_workers <= pool->num_workers) return;
+
+  if (pool->workers == NULL)
+    atexit(tilek_pool_shutdown);
 
-  num_threads = kernel->config->num_threads;
-  threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
-  threads_args = (struct tilek_worker_args_t *)malloc(num_threads * sizeof(struct tilek_worker_args_t));
+  pool->workers = (struct tilek_worker_t **)realloc(pool->workers, num_workers * sizeof(struct tilek_worker_t *));
 
   pthread_attr_t threads_attr;
   pthread_attr_init(&threads_attr);
   pthread_attr_setdetachstate(&threads_attr, PTHREAD_CREATE_JOINABLE);
 
-  void * status;
-  int rc;
-  int tid;
+  int i;
+  for (i = pool->num_workers; i < num_workers; i++) {
+    struct tilek_worker_t * worker = (struct tilek_worker_t *)malloc(sizeof(struct tilek_worker_t));
+    worker->tid = i + 1;
+    worker->generation = 0;
+    pool->workers[i] = worker;
 
-  for (tid = 0; tid < num_threads; tid++) {
-    threads_args[tid].tid = tid;
-    threads_args[tid].kernel = kernel;
-    threads_args[tid].subkernel = subkernel;
-    threads_args[tid].local_param = local_param;
-    threads_args[tid].local_data = local_data;
-    threads_args[tid].klt_loop_context = klt_loop_context;
-    threads_args[tid].klt_data_context = klt_data_context;
-    
-    rc = pthread_create(&threads[tid], &threads_attr, tilek_worker, &threads_args[tid]);
+    int rc = pthread_create(&worker->thread, &threads_attr, tilek_worker, worker);
     assert(!rc);
+    tilek_pin(worker->thread, worker->tid);
   }
 
   pthread_attr_destroy(&threads_attr);
 
-  for (tid = 0; tid < num_threads; tid++) {    
-    rc = pthread_join(threads[tid], &status);
-    assert(!rc);
+  pool->num_workers = num_workers;
+  pool->spin_count = num_workers < tilek_num_cpus() ? TILEK_SPIN_COUNT : 0;
+}
+
+// Runs the current launch of the pool on num_threads threads, the calling thread being thread 0
+static void tilek_pool_launch(int num_threads) {
+  struct tilek_pool_t * pool = &tilek_pool;
+  int i;
+
+  assert(num_threads > 0);
+  tilek_pool_grow(num_threads - 1);
+
+  pool->num_threads = num_threads;
+  pool->barrier.size = num_threads;
+  pool->barrier.count = num_threads;
+  __sync_synchronize();
+
+  for (i = 0; i < num_threads - 1; i++)
+    pool->workers[i]->generation++;
+  __sync_synchronize();
+
+  if (num_threads > 1 && pool->num_sleeping > 0) {
+    pthread_mutex_lock(&pool->mutex);
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
   }
 
-  free(threads_args); threads_args = 0;
-  free(threads); threads = 0;
-  num_threads = 0;
+  tilek_run(0);
+  tilek_barrier_wait(&pool->barrier);
 }
 
-void klt_user_wait(struct klt_kernel_t * kernel) { }
+void klt_user_schedule(
+  struct klt_kernel_t * kernel, struct klt_subkernel_desc_t * subkernel,
+  struct klt_loop_context_t * klt_loop_context, struct klt_data_context_t * klt_data_context
+) {
+  struct tilek_pool_t * pool = &tilek_pool;
+  int i;
+
+  if (tilek_in_launch) {
+    // nested launch: run all the threads of the subkernel one after the other, with their own arrays
+    void ** local_param = (void **)malloc(subkernel->num_params * sizeof(void *));
+    void ** local_data = (void **)malloc(subkernel->num_data * sizeof(void *));
+    for (i = 0; i < subkernel->num_params; i++)
+      local_param[i] = kernel->param[subkernel->param_ids[i]];
+    for (i = 0; i < subkernel->num_data; i++)
+      local_data[i] = kernel->data[subkernel->data_ids[i]].ptr;
+    for (i = 0; i < kernel->config->num_threads; i++)
+      (*subkernel->config->kernel_ptr)(i, local_param, local_data, klt_loop_context, klt_data_context);
+    free(local_param);
+    free(local_data);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->launch_mutex);
+
+  // the parameter and data arrays are reused between launches
+  if (subkernel->num_params > pool->max_params) {
+    pool->local_param = (void **)realloc(pool->local_param, subkernel->num_params * sizeof(void *));
+    pool->max_params = subkernel->num_params;
+  }
+  if (subkernel->num_data > pool->max_data) {
+    pool->local_data = (void **)realloc(pool->local_data, subkernel->num_data * sizeof(void *));
+    pool->max_data = subkernel->num_data;
+  }
+  for (i = 0; i < subkernel->num_params; i++)
+    pool->local_param[i] = kernel->param[subkernel->param_ids[i]];
+  for (i = 0; i < subkernel->num_data; i++)
+    pool->local_data[i] = kernel->data[subkernel->data_ids[i]].ptr;
+
+  pool->subkernel = subkernel;
+  pool->klt_loop_context = klt_loop_context;
+  pool->klt_data_context = klt_data_context;
+  pool->task = NULL;
+
+  tilek_pool_launch(kernel->config->num_threads);
+
+  pthread_mutex_unlock(&pool->launch_mutex);
+}
+
+void klt_user_wait(struct klt_kernel_t * kernel) {
+  (void)kernel;
+}
 
 int klt_user_get_tile_length(struct klt_kernel_t * kernel, unsigned long kind, unsigned long param) {
-  assert(kind == 2);
+  (void)kind;
+  (void)param;
+  assert(kind == e_tile_thread);
   return kernel->config->num_threads;
 }
 
+void tilek_parallel(int num_threads, void (*task)(int tid, int num_threads, void * arg), void * arg) {
+  struct tilek_pool_t * pool = &tilek_pool;
+
+  if (tilek_in_launch) {
+    int tid;
+    for (tid = 0; tid < num_threads; tid++)
+      (*task)(tid, num_threads, arg);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->launch_mutex);
+  pool->task = task;
+  pool->task_arg = arg;
+  tilek_pool_launch(num_threads);
+  pool->task = NULL;
+  pthread_mutex_unlock(&pool->launch_mutex);
+}
+
+struct tilek_first_touch_t {
+  char * ptr;
+  size_t size;
+};
+
+// Thread tid zeroes the tid-th block of the array, the block its thread tiles access
+static void tilek_first_touch_task(int tid, int num_threads, void * arg) {
+  struct tilek_first_touch_t * touch = (struct tilek_first_touch_t *)arg;
+  size_t begin = touch->size / num_threads * tid;
+  size_t end = tid == num_threads - 1 ? touch->size : touch->size / num_threads * (tid + 1);
+  memset(touch->ptr + begin, 0, end - begin);
+}
+
+void * tilek_first_touch_alloc(size_t size, int num_threads) {
+  void * ptr = NULL;
+  if (posix_memalign(&ptr, sysconf(_SC_PAGESIZE), size) != 0)
+    return NULL;
+
+  struct tilek_first_touch_t touch = { (char *)ptr, size };
+  tilek_parallel(num_threads > 0 ? num_threads : tilek_default_num_threads(), tilek_first_touch_task, &touch);
+  return ptr;
+}
+
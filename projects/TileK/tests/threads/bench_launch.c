@@ -0,0 +1,177 @@
+
+// Launch overhead of the threads runtime: executes a small kernel with a thread tile many times and
+// compares the time per launch with creating and joining the threads for every launch.
+//
+// Usage: bench_launch [num_threads [num_launches [n]]]
+
+#include "RTL/Host/tilek-rtl.h"
+
+#include "KLT/RTL/kernel.h"
+#include "KLT/RTL/loop.h"
+#include "KLT/RTL/tile.h"
+#include "KLT/RTL/data.h"
+#include "KLT/RTL/context.h"
+#include "KLT/RTL/build-context.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Kernel: A[i] += b for i in [0,n), tile[0](thread) tile[1](dynamic)
+
+void kernel_k0_v0_0(int tid, void ** param, void ** data, struct klt_loop_context_t * loop_ctx, struct klt_data_context_t * data_ctx) {
+  float b = *(float *)param[1];
+  float * A = (float *)data[0];
+
+  int t_0 = tid * klt_get_tile_stride(loop_ctx, 0);
+  int t_1;
+  for (t_1 = 0; t_1 < klt_get_tile_length(loop_ctx, 1); t_1 += klt_get_tile_stride(loop_ctx, 1))
+    A[t_0 + t_1] += b;
+}
+
+struct klt_subkernel_config_t config_k0_v0_0[1] = {
+  { &kernel_k0_v0_0 }
+};
+
+struct klt_tile_desc_t tile_desc_k0_v0_0_l0[2] = {
+  {0, 2, 0},
+  {1, 1, 0}
+};
+
+struct klt_loop_desc_t loops_k0_v0_0[1] = {
+  {0, 2, tile_desc_k0_v0_0_l0}
+};
+
+int param_ids_k0_v0_0[2] = {0, 1};
+int  data_ids_k0_v0_0[1] = {0};
+int loops_ids_k0_v0_0[1] = {0};
+int  deps_ids_k0_v0_0[0] = {};
+
+struct klt_subkernel_desc_t subkernels_k0_v0[1] = {
+  { {1, 2, loops_k0_v0_0}, 2, param_ids_k0_v0_0, 1, data_ids_k0_v0_0, 1, loops_ids_k0_v0_0, 0, deps_ids_k0_v0_0, config_k0_v0_0}
+};
+
+struct klt_version_selector_t version_selector_k0_v0[1] = {{}};
+
+struct klt_version_desc_t versions_k0[1] = {
+  {1, subkernels_k0_v0, version_selector_k0_v0}
+};
+
+int sizeof_param_k0[2] = {sizeof(int), sizeof(float)};
+int sizeof_data_k0[1] = {sizeof(float)};
+int ndims_data_k0[1] = {1};
+
+struct klt_loop_desc_t loop_desc_k0[1] = {
+  {0, 0, 0}
+};
+
+struct klt_kernel_desc_t klt_kernel_desc[1] = {
+  {
+    {2, sizeof_param_k0, 1, sizeof_data_k0, ndims_data_k0},
+    {1, 0, loop_desc_k0},
+    1, versions_k0
+  }
+};
+
+// Baseline: the previous scheduling, one thread created and joined per thread and launch
+
+struct baseline_args_t {
+  int tid;
+  void ** param;
+  void ** data;
+  struct klt_loop_context_t * loop_ctx;
+};
+
+static void * baseline_worker(void * args_) {
+  struct baseline_args_t * args = (struct baseline_args_t *)args_;
+  kernel_k0_v0_0(args->tid, args->param, args->data, args->loop_ctx, NULL);
+  return NULL;
+}
+
+static double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int check(float * A, int n, float expected_increment) {
+  int i;
+  for (i = 0; i < n; i++)
+    if (A[i] != i + expected_increment) {
+      printf("error: A[%d] = %f, expected %f\n", i, A[i], i + expected_increment);
+      return 0;
+    }
+  return 1;
+}
+
+int main(int argc, char ** argv) {
+  int num_threads  = argc > 1 ? atoi(argv[1]) : 4;
+  int num_launches = argc > 2 ? atoi(argv[2]) : 10000;
+  int n            = argc > 3 ? atoi(argv[3]) : 1024 * num_threads;
+  float b = 1.;
+  int i, l, tid;
+
+  n -= n % num_threads; // the thread tile needs a multiple of the number of threads
+
+  float * A = tilek_first_touch_alloc(n * sizeof(float), num_threads);
+  for (i = 0; i < n; i++)
+    A[i] = i;
+
+  struct klt_kernel_t * kernel = klt_build_kernel(0);
+  kernel->config->num_threads = num_threads;
+
+  kernel->param[0] = &n;
+  kernel->param[1] = &b;
+
+  kernel->data[0].ptr = &A[0];
+  kernel->data[0].sections[0].offset = 0;
+  kernel->data[0].sections[0].length = n;
+
+  kernel->loops[0].lower = 0;
+  kernel->loops[0].upper = n-1;
+  kernel->loops[0].stride = 1;
+
+  klt_execute_kernel(kernel); // creates the workers
+
+  double start = seconds();
+  for (l = 0; l < num_launches; l++)
+    klt_execute_kernel(kernel);
+  double pool_time = (seconds() - start) / num_launches;
+
+  if (!check(A, n, (num_launches + 1) * b)) return 1;
+
+  // The baseline runs the same kernel on the same loop context
+  struct klt_loop_context_t * loop_ctx = klt_build_loop_context(&(subkernels_k0_v0[0].loop), kernel->loops, kernel);
+  void * param[2] = { &n, &b };
+  void * data[1] = { A };
+  pthread_t * threads = malloc(num_threads * sizeof(pthread_t));
+  struct baseline_args_t * args = malloc(num_threads * sizeof(struct baseline_args_t));
+
+  start = seconds();
+  for (l = 0; l < num_launches; l++) {
+    for (tid = 0; tid < num_threads; tid++) {
+      args[tid].tid = tid;
+      args[tid].param = param;
+      args[tid].data = data;
+      args[tid].loop_ctx = loop_ctx;
+      pthread_create(&threads[tid], NULL, baseline_worker, &args[tid]);
+    }
+    for (tid = 0; tid < num_threads; tid++)
+      pthread_join(threads[tid], NULL);
+  }
+  double baseline_time = (seconds() - start) / num_launches;
+
+  if (!check(A, n, (2 * num_launches + 1) * b)) return 1;
+
+  printf("%d threads, %d launches, n = %d\n", num_threads, num_launches, n);
+  printf("  worker pool:            %10.2f us per launch\n", pool_time * 1e6);
+  printf("  threads per launch:     %10.2f us per launch\n", baseline_time * 1e6);
+
+  free(args);
+  free(threads);
+  free(A);
+
+  return 0;
+}
+
@@ -0,0 +1,49 @@
+// tilek_parallel from inside a tilek_parallel task (on the launching thread and on the workers) runs inline
+// instead of waiting forever for the outer launch to finish: test_nested [num_threads]
+
+#include "RTL/Host/tilek-rtl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_THREADS 64
+
+static int counts[MAX_THREADS][MAX_THREADS];
+
+static void inner_task(int tid, int num_threads, void * arg) {
+  int outer_tid = *(int *)arg;
+  if (num_threads <= MAX_THREADS)
+    counts[outer_tid][tid]++;
+}
+
+static void outer_task(int tid, int num_threads, void * arg) {
+  (void)arg;
+  tilek_parallel(num_threads, inner_task, &tid);
+}
+
+int main(int argc, char ** argv) {
+  int num_threads = argc > 1 ? atoi(argv[1]) : 4;
+  int i, j, errors = 0;
+  if (num_threads < 1 || num_threads > MAX_THREADS) {
+    fprintf(stderr, "number of threads must be between 1 and %d\n", MAX_THREADS);
+    return 1;
+  }
+
+  tilek_parallel(num_threads, outer_task, NULL);
+
+  for (i = 0; i < num_threads; i++)
+    for (j = 0; j < num_threads; j++)
+      if (counts[i][j] != 1) {
+        fprintf(stderr, "inner task %d of outer task %d ran %d times\n", j, i, counts[i][j]);
+        errors++;
+      }
+
+  // the pool still works after nested launches
+  tilek_parallel(num_threads, outer_task, NULL);
+  for (i = 0; i < num_threads; i++)
+    for (j = 0; j < num_threads; j++)
+      if (counts[i][j] != 2)
+        errors++;
+
+  return errors == 0 ? 0 : 1;
+}
@@ -287,8 +287,19 @@ namespace Compass {
     typedef boost::function<AstSimpleProcessingWithRunFunction* /*createSimpleTraversal*/(Parameters, OutputObject*)> SimpleTraversalCreationFunction;
     SimpleTraversalCreationFunction createSimpleTraversal;
 
+    /// The node variants (and their subclasses) for which the traversal's
+    /// visit function does anything.  A checker that declares them promises
+    /// that its run function is a plain preorder traversal of the project and
+    /// that visit ignores all other nodes and keeps no state across files;
+    /// such checkers are fused into a single traversal by runFusedCheckers.
+    /// Empty for checkers that cannot be fused.
+    VariantVector visitedVariants;
+
   CheckerUsingAstSimpleProcessing(std::string checkerName, std::string shortDescription, std::string longDescription, LanguageSet supportedLanguages, const PrerequisiteList& prerequisites, RunFunction run, SimpleTraversalCreationFunction createSimpleTraversal):
     Checker(checkerName, shortDescription, longDescription, supportedLanguages, prerequisites, run), createSimpleTraversal(createSimpleTraversal) {}
+
+  CheckerUsingAstSimpleProcessing(std::string checkerName, std::string shortDescription, std::string longDescription, LanguageSet supportedLanguages, const PrerequisiteList& prerequisites, RunFunction run, SimpleTraversalCreationFunction createSimpleTraversal, const VariantVector& visitedVariants):
+    Checker(checkerName, shortDescription, longDescription, supportedLanguages, prerequisites, run), createSimpleTraversal(createSimpleTraversal), visitedVariants(visitedVariants) {}
   };
 
   // ---- AST ---------------------------------------------------------------------------------------------------
@@ -354,6 +365,44 @@ namespace Compass {
 #endif
   };
 
+  /// An output object which only collects the violations, used to buffer
+  /// the output of checkers running in a worker thread
+  class BufferedOutputObject: public OutputObject
+  {
+  public:
+    virtual void addOutput(OutputViolationBase* theOutput) { outputList.push_back(theOutput); }
+  };
+
+  //! Number of threads used by runFusedCheckers; set with --compass:threads
+  extern size_t numberOfThreads;
+
+  //! Whether checkers are fused into one traversal; turned off with --compass:noFusion
+  extern bool UseFusion;
+
+  /// What a fused checker reported: its violations in AST order and, if it
+  /// threw, the reason
+  struct FusedCheckerResult {
+    BufferedOutputObject output;
+    bool failed;
+    std::string error;
+    FusedCheckerResult(): failed(false) {}
+  };
+
+  typedef std::map<const Checker*, FusedCheckerResult> FusedCheckerResults;
+
+  /// Run all checkers that declare their visited variants in one traversal
+  /// that dispatches each node to the checkers visiting its variant.  The
+  /// traversal runs on each file of the project in parallel (see
+  /// numberOfThreads), buffering each checker's output per file.  Each fused
+  /// checker gets an entry in results holding its violations in the order in
+  /// which running it alone reports them; the caller passes them to the
+  /// output when it reaches that checker, so that the output keeps the order
+  /// of the checker list.  Checkers without an entry were not run.  The
+  /// prerequisites must have been run.  Nothing is fused unless UseFusion is
+  /// set.
+  void runFusedCheckers(const std::vector<const Checker*>& checkers, SgProject* proj, Parameters params,
+                        FusedCheckerResults& results);
+
   // ToolGear Support
   void outputTgui( std::string & tguiXML, std::vector<const Compass::Checker*> & checkers, Compass::OutputObject *output );
   // tps (18Dec2008) : Added a guard because javaport testcase brakes on this
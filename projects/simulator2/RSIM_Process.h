@@ -3,6 +3,7 @@
 
 #include "RSIM_Callbacks.h"
 #include <Sawyer/BiMap.h>
+#include <boost/atomic.hpp>
 
 class RSIM_Thread;
 class RSIM_Simulator;
@@ -18,7 +19,8 @@ public:
     /** Creates an empty process containing no threads. */
     explicit RSIM_Process(RSIM_Simulator *simulator)
         : simulator(simulator), tracingFile_(NULL), tracingFlags_(0),
-          brkVa_(0), mmapNextVa_(0), mmapRecycle_(false), mmapGrowsDown_(false), disassembler_(NULL), futexes(NULL),
+          brkVa_(0), mmapNextVa_(0), mmapRecycle_(false), mmapGrowsDown_(false), memGeneration_(1),
+          disassembler_(NULL), futexes(NULL),
           interpretation_(NULL), entryPointOriginalVa_(0), entryPointStartVa_(0),
           terminated(false), termination_status(0), mainHeader_(NULL), project_(NULL), wordSize_(0), core_flags(0),
           btrace_file(NULL), core_styles(CORE_ELF), core_base_name("x-core.rose") {
@@ -198,8 +200,82 @@ private:
     rose_addr_t mmapNextVa_;                            // Minimum address to use when looking for mmap free space
     bool mmapRecycle_;                                  // If false, then never reuse mmap addresses
     bool mmapGrowsDown_;                                // If true then search down from a maximum, otherwise up from min
+    boost::atomic<size_t> memGeneration_;               // Incremented whenever the memory map changes; see mem_changed()
 
 public:
+    /** Per-thread cache of specimen-to-simulator page translations.
+     *
+     *  Each simulated thread owns one of these (see RSIM_Thread::memoryTlb) and passes it to the mem_read() and mem_write()
+     *  overloads that take a translation buffer.  An entry maps one specimen page to the simulator address of that page's
+     *  bytes, along with the segment's access bits.  Only pages that lie entirely within a single segment whose buffer has
+     *  directly addressable storage are cached, and copy-on-write buffers (see mem_transaction_start) are never cached.
+     *
+     *  Entries are stamped with the process memory generation (see mem_generation) when they are filled and are ignored once
+     *  the generation changes, so any modification of the memory map through the RSIM_Process API invalidates all threads'
+     *  translations without any cross-thread communication.  Code that modifies the map returned by get_memory() directly
+     *  must call mem_changed() before releasing the rwlock().  Entries are only checked and used while the rwlock() is held,
+     *  which is what keeps another thread from unmapping or copy-on-write protecting a page in the middle of a copy; the
+     *  savings come from not searching the memory map, not from avoiding the lock.
+     *
+     *  Thread safety: A translation buffer must only be used by one thread at a time. */
+    class MemoryTlb {
+    public:
+        static const size_t PAGE_BITS = 12;             /**< Log base two of the translation granularity. */
+        static const size_t N_ENTRIES = 256;            /**< Number of direct-mapped entries. */
+
+    private:
+        friend class RSIM_Process;
+
+        struct Entry {
+            rose_addr_t pageVa;                         // specimen address of start of page
+            uint8_t *host;                              // simulator address of the page's first byte, or null if invalid
+            unsigned accessibility;                     // MemoryMap access bits of the containing segment
+            bool hostWritable;                          // true if the bytes can be modified in place
+            size_t generation;                          // process memory generation when this entry was filled
+            Rose::BinaryAnalysis::MemoryMap::Buffer::Ptr buffer; // keeps the storage alive while the entry is valid
+
+            Entry(): pageVa(0), host(NULL), accessibility(0), hostWritable(false), generation(0) {}
+        };
+
+        Entry entries_[N_ENTRIES];
+        size_t nHits_, nMisses_;
+
+    public:
+        MemoryTlb(): nHits_(0), nMisses_(0) {}
+
+        /** Invalidate all entries. */
+        void clear() {
+            for (size_t i=0; i<N_ENTRIES; ++i)
+                entries_[i] = Entry();
+        }
+
+        /** Number of accesses satisfied without consulting the memory map. */
+        size_t nHits() const { return nHits_; }
+
+        /** Number of accesses that needed to (re)fill an entry. */
+        size_t nMisses() const { return nMisses_; }
+    };
+
+    /** Current memory map generation.
+     *
+     *  The generation is incremented each time the memory map is modified in a way that could invalidate cached translations
+     *  (mapping, unmapping, protection changes, transactions, etc.).
+     *
+     *  Thread safety: This method is thread safe. */
+    size_t mem_generation() const {
+        return memGeneration_.load();
+    }
+
+    /** Notify that the memory map has changed.
+     *
+     *  The mem_map, mem_unmap, mem_protect, mem_setbrk, and memory transaction methods call this automatically. Any other code
+     *  that modifies the map returned by get_memory() (inserting or erasing segments, changing access bits, etc.) must call
+     *  this while still holding the rwlock() so that threads discard their cached translations.
+     *
+     *  Thread safety: This method is thread safe. */
+    void mem_changed() {
+        ++memGeneration_;
+    }
 
     /** Returns the memory map for the simulated process.  MemoryMap is not thread safe [as of 2011-03-31], so all access to
      *  the map should be protected by the process-wide read-write lock returned by the rwlock() method. */
@@ -290,6 +366,31 @@ public:
     size_t mem_read(void *buf, rose_addr_t va, size_t size,
                     unsigned req_perms = Rose::BinaryAnalysis::MemoryMap::READABLE);
 
+    /** Copy data using a translation buffer.
+     *
+     *  These behave identically to the mem_write() and mem_read() methods above (including invocation of the memory
+     *  callbacks), except accesses that fall within a single page are first looked up in the supplied translation buffer and,
+     *  on a hit, are satisfied by copying directly to or from the simulator's memory without consulting the memory map.
+     *  Accesses that miss, span pages, or touch memory that cannot be cached fall back to the memory map.  Either way the
+     *  copy happens while holding the rwlock(), so it is ordered with respect to mem_unmap, mem_protect, and the memory
+     *  transaction methods.
+     *
+     *  Thread safety: These methods are thread safe provided the translation buffer is not shared between threads.
+     *
+     *  @{ */
+    size_t mem_write(MemoryTlb&, const void *buf, rose_addr_t va, size_t size,
+                     unsigned req_perms = Rose::BinaryAnalysis::MemoryMap::WRITABLE);
+    size_t mem_read(MemoryTlb&, void *buf, rose_addr_t va, size_t size,
+                    unsigned req_perms = Rose::BinaryAnalysis::MemoryMap::READABLE);
+    /** @} */
+
+private:
+    // Returns the simulator address for the specified specimen bytes if they are covered by a valid (possibly refilled)
+    // translation with the required access, otherwise null.
+    uint8_t *mem_translate(MemoryTlb&, rose_addr_t va, size_t size, unsigned req_perms, bool forWriting);
+
+public:
+
     /** Reads a NUL-terminated string from specimen memory. The NUL is not included in the string.  If a limit is specified
      *  then the returned string will contain at most this many characters (a value of zero implies no limit).  If the string
      *  cannot be read, then "error" (if non-null) will point to a true value and the returned string will include the
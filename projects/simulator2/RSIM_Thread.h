@@ -18,6 +18,7 @@ private:
     SAWYER_THREAD_TRAITS::ConditionVariable runStateChanged_;
     RunState runState_;
     RSIM_Semantics::DispatcherPtr dispatcher_;
+    RSIM_Process::MemoryTlb memoryTlb_;                 // cached page translations; used only by this thread
     
 public:
 
@@ -55,6 +56,16 @@ public:
         return process;
     }
 
+    /** Translation buffer for this thread's specimen memory accesses.
+     *
+     *  The instruction semantics pass this to RSIM_Process::mem_read and RSIM_Process::mem_write so that most loads and stores
+     *  avoid searching the memory map.  See RSIM_Process::MemoryTlb for how entries are invalidated.
+     *
+     *  Thread safety: This should only be called by the simulator thread that owns this object. */
+    RSIM_Process::MemoryTlb& memoryTlb() {
+        return memoryTlb_;
+    }
+
     /** Cause a thread to start running.  This must be called after a thread is created in order for it to start doing
      * anything.
      *
@@ -0,0 +1,312 @@
+#ifndef Rose_BinaryAnalysis_IndexedSerialIo_H
+#define Rose_BinaryAnalysis_IndexedSerialIo_H
+
+#include <BinarySerialIo.h>
+#include <Partitioner2/BasicBlock.h>
+#include <Partitioner2/Function.h>
+
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <Sawyer/Map.h>
+#include <Sawyer/Optional.h>
+#include <string>
+#include <vector>
+
+namespace Rose {
+namespace BinaryAnalysis {
+
+/** Random-access state files.
+ *
+ *  The @ref SerialOutput and @ref SerialInput classes store a partitioner as a single Boost archive, which means that the
+ *  entire partitioner (every function, basic block, instruction AST, and semantic state) must be decoded before anything can
+ *  be queried. The classes in this namespace store the same information in an indexed, sectioned file instead, which can be
+ *  mapped into memory and from which individual functions, basic blocks, and instructions are decoded on demand.
+ *
+ *  The file consists of a fixed-size header, a table of section headers, and the following sections:
+ *
+ *  @li A function table sorted by entry address. Each entry has the function's name (an offset into the string table), the
+ *      number of basic blocks it owns, and the location of its encoded @ref Partitioner2::Function object.
+ *
+ *  @li A basic block table sorted by starting address. Each entry has the number of instructions and the location of the
+ *      encoded @ref Partitioner2::BasicBlock object, including its instruction ASTs.
+ *
+ *  @li An instruction table sorted by address that maps each instruction to the basic block that owns it.
+ *
+ *  @li A string table holding function names.
+ *
+ *  @li The encoded functions and basic blocks. Each is an independent Boost binary archive, therefore each can be encoded
+ *      or decoded without any of the others, and they can be encoded in parallel.
+ *
+ *  @li Optionally, the entire partitioner as a single archive (identical to what @ref SerialOutput writes) so that a complete
+ *      @ref Partitioner2::Partitioner can still be restored from the file.
+ *
+ *  Since the encoded objects are independent, objects shared between basic blocks (such as data blocks) become separate
+ *  objects when the basic blocks are individually materialized. Like the @ref SerialIo::BINARY format, indexed files are
+ *  not portable across architectures.
+ *
+ *  Here's an example that looks at just one function of a large specimen:
+ *
+ * @code
+ *  using namespace Rose::BinaryAnalysis;
+ *  namespace P2 = Rose::BinaryAnalysis::Partitioner2;
+ *
+ *  IndexedSerialInput::Ptr input = IndexedSerialInput::instance();
+ *  input->open("specimen.rbx");
+ *  if (P2::Function::Ptr function = input->loadFunction(0x08048a10)) {
+ *      BOOST_FOREACH (rose_addr_t va, function->basicBlockAddresses()) {
+ *          P2::BasicBlock::Ptr bb = input->loadBasicBlock(va);
+ *          ...
+ *      }
+ *  }
+ * @endcode */
+namespace IndexedSerialIo {
+
+/** Magic number at the start of every indexed state file. */
+static const char MAGIC[8] = {'R', 'O', 'S', 'E', 'R', 'B', 'A', 'X'};
+
+/** File format version number. */
+static const boost::uint32_t VERSION = 1;
+
+/** Section types. */
+enum SectionType {
+    SECTION_STRINGS     = 1,                            /**< Function names. */
+    SECTION_FUNCTIONS   = 2,                            /**< Function table (array of @ref FunctionEntry). */
+    SECTION_BLOCKS      = 3,                            /**< Basic block table (array of @ref BlockEntry). */
+    SECTION_INSNS       = 4,                            /**< Instruction table (array of @ref InsnEntry). */
+    SECTION_CHUNKS      = 5,                            /**< Encoded functions and basic blocks. */
+    SECTION_PARTITIONER = 6                             /**< Entire partitioner as one archive. */
+};
+
+/** File header. */
+struct FileHeader {
+    char magic[8];                                      /**< Always @ref MAGIC. */
+    boost::uint32_t version;                            /**< File format version. */
+    boost::uint32_t nSections;                          /**< Number of entries in the section table. */
+    boost::uint64_t sectionTableOffset;                 /**< File offset for the section table. */
+};
+
+/** Entry in the section table. */
+struct SectionHeader {
+    boost::uint32_t type;                               /**< A @ref SectionType. */
+    boost::uint32_t reserved;                           /**< Always zero. */
+    boost::uint64_t offset;                             /**< File offset for the start of the section. */
+    boost::uint64_t size;                               /**< Size of the section in bytes. */
+    boost::uint64_t nEntries;                           /**< Number of table entries, or zero for non-table sections. */
+};
+
+/** Entry in the function table. */
+struct FunctionEntry {
+    boost::uint64_t entryVa;                            /**< Function entry address. */
+    boost::uint64_t nameOffset;                         /**< Offset of the name in the string table. */
+    boost::uint32_t nameSize;                           /**< Length of the name in bytes. */
+    boost::uint32_t nBasicBlocks;                       /**< Number of basic blocks owned by the function. */
+    boost::uint64_t chunkOffset;                        /**< File offset of the encoded function. */
+    boost::uint64_t chunkSize;                          /**< Size of the encoded function in bytes. */
+};
+
+/** Entry in the basic block table. */
+struct BlockEntry {
+    boost::uint64_t startVa;                            /**< Starting address of the basic block. */
+    boost::uint32_t nInstructions;                      /**< Number of instructions in the basic block. */
+    boost::uint32_t reserved;                           /**< Always zero. */
+    boost::uint64_t chunkOffset;                        /**< File offset of the encoded basic block. */
+    boost::uint64_t chunkSize;                          /**< Size of the encoded basic block in bytes. */
+};
+
+/** Entry in the instruction table. */
+struct InsnEntry {
+    boost::uint64_t va;                                 /**< Instruction address. */
+    boost::uint32_t size;                               /**< Instruction size in bytes. */
+    boost::uint32_t blockIndex;                         /**< Index of owning basic block in the basic block table. */
+};
+
+} // namespace
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IndexedSerialOutput
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** Output binary analysis state as an indexed file.
+ *
+ *  See @ref IndexedSerialIo for a description of the file format. The functions and basic blocks are encoded in parallel
+ *  using the number of threads specified by the @ref nThreads property and then written to the file along with the
+ *  tables that index them. Only one partitioner can be saved per file. */
+class IndexedSerialOutput: public SerialIo {
+public:
+    typedef Sawyer::SharedPointer<IndexedSerialOutput> Ptr;
+
+private:
+    size_t nThreads_;
+    bool savingWholePartitioner_;
+    bool hasPartitioner_;
+
+protected:
+    IndexedSerialOutput()
+        : nThreads_(0), savingWholePartitioner_(true), hasPartitioner_(false) {}
+
+public:
+    ~IndexedSerialOutput();
+    void open(const boost::filesystem::path &fileName) ROSE_OVERRIDE;
+    void close() ROSE_OVERRIDE;
+
+    /** Factory method to create a new instance.
+     *
+     *  The returned instance is in a detached state, therefore the @ref open method needs to be called before the
+     *  partitioner can be saved. */
+    static Ptr instance() { return Ptr(new IndexedSerialOutput); }
+
+    /** Property: Number of threads used to encode objects.
+     *
+     *  A value of zero means use the number of threads specified on the command-line (or the hardware concurrency if none
+     *  was specified).
+     *
+     * @{ */
+    size_t nThreads() const { return nThreads_; }
+    void nThreads(size_t n) { nThreads_ = n; }
+    /** @} */
+
+    /** Property: Whether to also save the entire partitioner.
+     *
+     *  If set (the default), the entire partitioner is also stored as a single archive so that @ref
+     *  IndexedSerialInput::loadPartitioner can restore it. Clearing this property makes the file smaller and faster to
+     *  write but only the random-access queries are then available.
+     *
+     * @{ */
+    bool savingWholePartitioner() const { return savingWholePartitioner_; }
+    void savingWholePartitioner(bool b) { savingWholePartitioner_ = b; }
+    /** @} */
+
+    /** Save a binary analysis partitioner.
+     *
+     *  Encodes the partitioner's functions and basic blocks and writes them, and their indexes, to the attached file.
+     *
+     *  Throws an @ref Exception if the partitioner cannot be saved, or if a partitioner was already saved to this file.
+     *
+     *  Thread safety: This method is not thread-safe. No other thread should be modifying the partitioner. */
+    void savePartitioner(const Partitioner2::Partitioner&);
+
+private:
+    void writeAll(const void *buf, size_t nBytes);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IndexedSerialInput
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** Input binary analysis state from an indexed file.
+ *
+ *  The file is mapped into memory when it's opened and only the header and section table are examined. Functions, basic
+ *  blocks, and instructions are decoded the first time they're requested and are cached thereafter, so asking for the same
+ *  object twice returns the same pointer.
+ *
+ *  Thread safety: All query and load methods are thread-safe, so multiple threads can materialize different parts of the
+ *  same file concurrently. Opening and closing are not thread-safe. */
+class IndexedSerialInput: public SerialIo {
+public:
+    typedef Sawyer::SharedPointer<IndexedSerialInput> Ptr;
+
+private:
+    boost::iostreams::mapped_file_source mapped_;
+    const IndexedSerialIo::FunctionEntry *functions_;
+    size_t nFunctions_;
+    const IndexedSerialIo::BlockEntry *blocks_;
+    size_t nBlocks_;
+    const IndexedSerialIo::InsnEntry *insns_;
+    size_t nInsns_;
+    const char *strings_;
+    size_t stringsSize_;
+    const char *partitioner_;
+    size_t partitionerSize_;
+
+    mutable SAWYER_THREAD_TRAITS::Mutex cacheMutex_;    // protects the following caches
+    Sawyer::Container::Map<size_t /*function index*/, Partitioner2::Function::Ptr> functionCache_;
+    Sawyer::Container::Map<size_t /*block index*/, Partitioner2::BasicBlock::Ptr> blockCache_;
+
+protected:
+    IndexedSerialInput()
+        : functions_(NULL), nFunctions_(0), blocks_(NULL), nBlocks_(0), insns_(NULL), nInsns_(0), strings_(NULL),
+          stringsSize_(0), partitioner_(NULL), partitionerSize_(0) {}
+
+public:
+    ~IndexedSerialInput();
+    void open(const boost::filesystem::path &fileName) ROSE_OVERRIDE;
+    void close() ROSE_OVERRIDE;
+
+    /** Factory method to create a new instance.
+     *
+     *  The returned instance is in a detached state, therefore the @ref open method needs to be called before any
+     *  queries. */
+    static Ptr instance() { return Ptr(new IndexedSerialInput); }
+
+    /** Test whether a file is an indexed state file.
+     *
+     *  Returns true if the file exists and starts with the indexed state file magic number. */
+    static bool isIndexedFile(const boost::filesystem::path&);
+
+    /** Number of functions in the file. */
+    size_t nFunctions() const { return nFunctions_; }
+
+    /** Number of basic blocks in the file. */
+    size_t nBasicBlocks() const { return nBlocks_; }
+
+    /** Number of instructions in the file. */
+    size_t nInstructions() const { return nInsns_; }
+
+    /** Entry addresses of all functions, sorted.
+     *
+     *  This doesn't decode any functions. */
+    std::vector<rose_addr_t> functionAddresses() const;
+
+    /** Name of a function.
+     *
+     *  Returns the name of the function whose entry address is specified, or nothing if there is no such function. This
+     *  doesn't decode the function. */
+    Sawyer::Optional<std::string> functionName(rose_addr_t entryVa) const;
+
+    /** Load a function.
+     *
+     *  Returns the function whose entry address is specified, decoding it if necessary. Returns null if there is no such
+     *  function. The function's basic blocks are not loaded; use @ref loadBasicBlock for them. */
+    Partitioner2::Function::Ptr loadFunction(rose_addr_t entryVa);
+
+    /** Load a basic block.
+     *
+     *  Returns the basic block starting at the specified address, decoding it (and its instructions) if necessary. Returns
+     *  null if there is no such basic block. */
+    Partitioner2::BasicBlock::Ptr loadBasicBlock(rose_addr_t startVa);
+
+    /** Load the basic block that contains an instruction.
+     *
+     *  Returns the basic block that owns the instruction that starts at the specified address, or null if there is no
+     *  such instruction. */
+    Partitioner2::BasicBlock::Ptr loadBasicBlockContaining(rose_addr_t insnVa);
+
+    /** Load an instruction.
+     *
+     *  Returns the instruction starting at the specified address by decoding the basic block that owns it, or null if
+     *  there is no such instruction. */
+    SgAsmInstruction* loadInstruction(rose_addr_t insnVa);
+
+    /** Whether the file contains the entire partitioner. */
+    bool hasPartitioner() const { return partitioner_ != NULL; }
+
+    /** Load the entire partitioner.
+     *
+     *  This is as expensive as @ref SerialInput::loadPartitioner. Throws an @ref Exception if the file was written without
+     *  the entire partitioner (see @ref IndexedSerialOutput::savingWholePartitioner). */
+    Partitioner2::Partitioner loadPartitioner();
+
+private:
+    Sawyer::Optional<size_t> findFunctionIndex(rose_addr_t entryVa) const;
+    Sawyer::Optional<size_t> findBlockIndex(rose_addr_t startVa) const;
+    Sawyer::Optional<size_t> findInsnIndex(rose_addr_t va) const;
+    Partitioner2::BasicBlock::Ptr loadBasicBlockAtIndex(size_t idx);
+    const char* chunk(boost::uint64_t offset, boost::uint64_t size) const;
+};
+
+} // namespace
+} // namespace
+
+#endif
@@ -3,6 +3,7 @@
 #define ROSE_BinaryAnalysis_Unparser_H
 
 #include <Sawyer/CommandLine.h>
+#include <Sawyer/Optional.h>
 #include <BaseSemantics2.h>
 #include <BinaryEdgeArrows.h>
 
@@ -97,6 +98,13 @@ struct Settings {
         EdgeArrows::ArrowStylePreset style;             /**< One of the arrow style presets. */
     } arrow;                                            /**< How to render arrows along the left margin. */
 
+    /** Number of threads used to render whole-program listings.
+     *
+     *  When unparsing all functions, each function is rendered into its own buffer by a pool of worker threads and the
+     *  buffers are then written in the usual order. If this has no value (the default) then listings are produced by the
+     *  calling thread alone. A value of zero means use the hardware concurrency. */
+    Sawyer::Optional<size_t> nThreads;
+
     Settings();
     static Settings full();
     static Settings minimal();
@@ -3,6 +3,7 @@
 
 #include <BinaryEdgeArrows.h>
 #include <BinaryReachability.h>
+#include <BinarySmtSolver.h>
 #include <BinaryUnparser.h>
 #include <BitFlags.h>
 #include <Partitioner2/BasicTypes.h>
@@ -11,6 +12,7 @@
 #include <Sawyer/Map.h>
 #include <Sawyer/Message.h>
 #include <Sawyer/SharedObject.h>
+#include <boost/shared_ptr.hpp>
 #include <Progress.h>
 #include <Registers.h>
 
@@ -82,14 +84,17 @@ public:
 /** State for unparsing.
  *
  *  This object stores the current state for unparsing. The state is kept separate from the unparser class so that (1) the
- *  unparser can be a const reference, and (2) multiple threads can be unparsing with the same unparser object. */
+ *  unparser can be a const reference, and (2) multiple threads can be unparsing with the same unparser object.
+ *
+ *  States may be copied. The per-partitioner tables, such as the function call graph and the CFG vertex reachability, are
+ *  read-only and shared among the copies, so copying an initialized state costs only the per-function parts. */
 class State {
 public:
     typedef Sawyer::Container::Map<rose_addr_t, std::string> AddrString;/**< Map from address to string. */
 
 private:
     const Partitioner2::Partitioner &partitioner_;
-    Partitioner2::FunctionCallGraph cg_;
+    boost::shared_ptr<const Partitioner2::FunctionCallGraph> cg_;       // shared by copies of this state
     Partitioner2::FunctionPtr currentFunction_;
     Partitioner2::BasicBlockPtr currentBasicBlock_;
     Sawyer::Optional<EdgeArrows::VertexId> currentPredSuccId_;
@@ -97,12 +102,13 @@ private:
     AddrString basicBlockLabels_;
     RegisterNames registerNames_;
     const Base &frontUnparser_;
-    std::vector<Reachability::ReasonFlags> cfgVertexReachability_;
+    boost::shared_ptr<const std::vector<Reachability::ReasonFlags> > cfgVertexReachability_; // shared by copies; null if none
     Sawyer::Container::Map<Reachability::ReasonFlags::Vector, std::string> reachabilityNames_; // map reachability value to name
     ArrowMargin intraFunctionCfgArrows_;                              // arrows for the intra-function control flow graphs
     ArrowMargin intraFunctionBlockArrows_;                            // user-defined intra-function arrows to/from blocks
     ArrowMargin globalBlockArrows_;                                   // user-defined global arrows to/from blocks
     bool cfgArrowsPointToInsns_;                                      // arrows point to insns? else predecessor/successor lines
+    SmtSolverPtr semanticsSolver_;                                    // solver for instruction semantics, or null
 
 public:
     State(const Partitioner2::Partitioner&, const Settings&, const Base &frontUnparser);
@@ -115,10 +121,10 @@ public:
     /** Property: Reachability analysis results.
      *
      *  This property stores a vector indexed by CFG vertex IDs that holds information about whether the vertex is reachable
-     *  and why.
+     *  and why. Setting the property replaces the vector in this state only; copies made earlier keep sharing the old one.
      *
      * @{ */
-    const std::vector<Reachability::ReasonFlags> cfgVertexReachability() const;
+    const std::vector<Reachability::ReasonFlags>& cfgVertexReachability() const;
     void cfgVertexReachability(const std::vector<Reachability::ReasonFlags>&);
     /** @} */
 
@@ -200,6 +206,17 @@ public:
     bool cfgArrowsPointToInsns() const { return cfgArrowsPointToInsns_; }
     void cfgArrowsPointToInsns(bool b) { cfgArrowsPointToInsns_ = b; }
     /** @} */
+
+    /** Property: SMT solver for instruction semantics.
+     *
+     *  When instruction semantics are shown, they're evaluated using this solver. If the solver is null then a new one is
+     *  created from the partitioner's solver for each instruction. SMT solvers are not thread-safe, therefore states that are
+     *  used concurrently must not share a solver.
+     *
+     * @{ */
+    SmtSolverPtr semanticsSolver() const { return semanticsSolver_; }
+    void semanticsSolver(const SmtSolverPtr &solver) { semanticsSolver_ = solver; }
+    /** @} */
     
     /** Assign a reachability name to a reachability value.
      *
@@ -396,6 +413,19 @@ public:
     std::string unparse(const Partitioner2::Partitioner&, const Partitioner2::FunctionPtr&) const /*final*/;
     /** @} */
 
+    /** Create an initialized state.
+     *
+     *  Returns a state that has been initialized by @ref initializeState. Programs that stream individual functions can create
+     *  one such state and then emit each function with a copy of it, as in <code>State s(prototype); unparser->emitFunction(out,
+     *  function, s)</code>, which avoids recomputing the per-partitioner tables such as the function call graph for every
+     *  function. */
+    State initialState(const Partitioner2::Partitioner&) const /*final*/;
+
+private:
+    // Emit all functions using multiple threads. Returns false (without emitting anything) if the output can only be produced
+    // sequentially.
+    bool unparseInParallel(std::ostream&, const Partitioner2::Partitioner&, const Progress::Ptr&, size_t nThreads) const;
+
 public:
     /** Mid-level unparser function.
      *
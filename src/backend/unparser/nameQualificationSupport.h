@@ -24,6 +24,105 @@
 // API function for new hidden list support.
 void generateNameQualificationSupport( SgNode* node, std::set<SgNode*> & referencedNameSet );
 
+// Per-file cache of the symbol table queries made while computing name qualification.
+// The same (scope,name) pairs are looked up for every reference to a named construct
+// (and repeatedly for each template argument of each reference), and each lookup walks
+// the chain of parent scopes probing their symbol tables.  Since the symbol tables are
+// not modified by the name qualification traversal, the results are memoized here for
+// the lifetime of one call to generateNameQualificationSupport().  Any AST transformation
+// between calls invalidates the cache by construction (a new cache is built for each
+// call); code that edits the AST while holding a cache must call clear().
+class NameQualificationLookupCache
+   {
+     public:
+       // The kind of query, used to keep results for different symbol kinds distinct.
+          enum LookupKind
+             {
+               e_unknown_lookup = 0,
+               e_symbol_lookup,
+               e_variable_symbol_lookup,
+               e_class_symbol_lookup,
+               e_namespace_symbol_lookup,
+               e_function_symbol_lookup,
+               e_typed_function_symbol_lookup,
+               e_typedef_symbol_lookup,
+               e_enum_symbol_lookup,
+               e_template_symbol_lookup,
+               e_template_class_symbol_lookup,
+               e_nonreal_symbol_lookup,
+               e_symbol_count,
+               e_alias_symbol_count,
+               e_last_lookup
+             };
+
+          NameQualificationLookupCache();
+
+       // Cached versions of the SageInterface::lookup*SymbolInParentScopes() functions.  Template parameter
+       // and template argument lists are part of the key by address: they are owned by declarations in the
+       // AST, which is not modified while the cache is in use.  A NULL scope means the top of the SageBuilder
+       // scope stack, as it does for the SageInterface functions, and such lookups bypass the cache.
+          SgSymbol*          lookupSymbolInParentScopes         ( const SgName & name, SgScopeStatement* currentScope,
+                                                                  SgTemplateParameterPtrList* templateParameterList = NULL,
+                                                                  SgTemplateArgumentPtrList* templateArgumentList = NULL );
+          SgVariableSymbol*  lookupVariableSymbolInParentScopes ( const SgName & name, SgScopeStatement* currentScope );
+          SgClassSymbol*     lookupClassSymbolInParentScopes    ( const SgName & name, SgScopeStatement* currentScope,
+                                                                  SgTemplateArgumentPtrList* templateArgumentList = NULL );
+          SgNamespaceSymbol* lookupNamespaceSymbolInParentScopes( const SgName & name, SgScopeStatement* currentScope );
+          SgFunctionSymbol*  lookupFunctionSymbolInParentScopes ( const SgName & name, SgScopeStatement* currentScope );
+          SgFunctionSymbol*  lookupFunctionSymbolInParentScopes ( const SgName & name, const SgType* functionType, SgScopeStatement* currentScope );
+          SgTypedefSymbol*   lookupTypedefSymbolInParentScopes  ( const SgName & name, SgScopeStatement* currentScope );
+          SgEnumSymbol*      lookupEnumSymbolInParentScopes     ( const SgName & name, SgScopeStatement* currentScope );
+          SgTemplateSymbol*  lookupTemplateSymbolInParentScopes ( const SgName & name, SgScopeStatement* currentScope );
+          SgTemplateClassSymbol* lookupTemplateClassSymbolInParentScopes ( const SgName & name, SgTemplateParameterPtrList* templateParameterList,
+                                                                           SgTemplateArgumentPtrList* templateArgumentList, SgScopeStatement* currentScope );
+          SgNonrealSymbol*   lookupNonrealSymbolInParentScopes  ( const SgName & name, SgScopeStatement* currentScope,
+                                                                  SgTemplateParameterPtrList* templateParameterList,
+                                                                  SgTemplateArgumentPtrList* templateArgumentList );
+
+       // Cached versions of SgScopeStatement::count_symbol() and SgScopeStatement::count_alias_symbol(),
+       // used to detect names that are hidden or ambiguous in a given scope.
+          size_t count_symbol       ( const SgName & name, SgScopeStatement* scope );
+          size_t count_alias_symbol ( const SgName & name, SgScopeStatement* scope );
+
+       // Discard all cached results (required if the AST is modified while the cache is in use).
+          void clear();
+
+       // Statistics (reported in debug output).
+          size_t get_numberOfHits()   const;
+          size_t get_numberOfMisses() const;
+          size_t size() const;
+
+     private:
+          struct Key
+             {
+               LookupKind        kind;
+               SgScopeStatement* scope;
+               const void*       discriminator;
+               const void*       secondDiscriminator;
+               std::string       name;
+
+               Key(LookupKind k, SgScopeStatement* s, const void* d, const SgName & n, const void* d2 = NULL);
+               bool operator==(const Key & x) const;
+             };
+
+          struct KeyHash
+             {
+               size_t operator()(const Key & key) const;
+             };
+
+          typedef rose_hash::unordered_map<Key,SgSymbol*,KeyHash> SymbolCache;
+          typedef rose_hash::unordered_map<Key,size_t,KeyHash>    CountCache;
+
+          SymbolCache symbolCache;
+          CountCache  countCache;
+
+          size_t numberOfHits;
+          size_t numberOfMisses;
+
+       // Returns true (and sets result) if the key is in the cache.
+          bool find(const Key & key, SgSymbol* & result);
+   };
+
 class NameQualificationInheritedAttribute
    {
      private:
@@ -136,6 +235,9 @@ class NameQualificationTraversal : public AstTopDownBottomUpProcessing<NameQuali
        // specified. I think this only happens for the index in the SgArrayType.
           SgScopeStatement* explictlySpecifiedCurrentScope;
 
+       // Memoized symbol table queries, shared with nested traversals (see NameQualificationLookupCache).
+          NameQualificationLookupCache* lookupCache;
+
      public:
        // DQ (3/24/2016): Adding Robb's meageage mechanism (data member and function).
           static Sawyer::Message::Facility mlog;
@@ -146,6 +248,10 @@ class NameQualificationTraversal : public AstTopDownBottomUpProcessing<NameQuali
        // placed into scopes where they would permit name qualification (see test2014_32.C).
           SageInterface::DeclarationSets* declarationSet;
 
+       // Set the cache of symbol table queries (owned by the caller, must outlive the traversal).
+          void set_lookupCache(NameQualificationLookupCache* cache);
+          NameQualificationLookupCache* get_lookupCache() const;
+
      public:
        // HiddenListTraversal();
        // HiddenListTraversal(SgNode* root);
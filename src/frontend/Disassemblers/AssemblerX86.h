@@ -18,18 +18,21 @@ namespace BinaryAnalysis {
  *  any instructions; it only knows how to encode various prefixes and operand addressing modes.  For each instruction to be
  *  assembled, the assembler consults a dictionary of assembly definitions. The instruction is looked up in this dictionary and
  *  the chosen definition then drives the assembly. If the instruction being assembled matches multiple definitions then each
- *  valid definition is tried and the "best" one (see Assembler::set_encoding_type()) is returned.
+ *  valid definition is tried and the "best" one (see Assembler::set_encoding_type()) is returned. Each assembler remembers
+ *  which definitions matched instructions of the same kind and operand shapes (the same registers, memory operand types, and
+ *  ranges of constant values), so that the other definitions aren't tried again.
  *
  *  The dictionary is generated directly from the Intel "Instruction Set Reference" PDF documentation as augmented by a small
  *  text file in this directory. The IntelAssemblyBuilder perl script generates AssemblerX86Init.h and AssemblerX86Init.C, which
  *  contain the X86InstructionKind enumeration, a function to initialize the dictionary (AssemblerX86::initAssemblyRules()),
- *  and a function for converting an X86InstructionKind constant to a string (AssemblerX86::to_str()). */
+ *  and a function for converting an X86InstructionKind constant to a string (AssemblerX86::to_str()). The definitions
+ *  themselves are statically initialized tables in AssemblerX86Init1.C through AssemblerX86Init9.C. */
 class AssemblerX86: public Assembler {
 public:
     AssemblerX86()
-        : honor_operand_types(false) {
+        : honor_operand_types(false), use_encoding_cache(true) {
         if (defns.size()==0)
-            initAssemblyRules();
+            build_dictionary();
     }
 
     virtual ~AssemblerX86() {}
@@ -52,6 +55,26 @@ public:
         return honor_operand_types;
     }
 
+    /** Causes the assembler to remember (if true) which dictionary definitions match each encoding signature of the
+     *  instructions it assembles, so that later instructions with the same signature only try those definitions, or (if
+     *  false) to try every definition of the instruction's kind. The encoding is the same either way. The cache is used by
+     *  default. Turning it off also empties it. */
+    void set_use_encoding_cache(bool b) {
+        use_encoding_cache = b;
+        if (!b)
+            encoding_cache.clear();
+    }
+
+    /** Returns true if the assembler is caching the definitions that match each encoding signature. */
+    bool get_use_encoding_cache() const {
+        return use_encoding_cache;
+    }
+
+    /** Returns the number of encoding signatures whose matching definitions are cached. */
+    size_t get_encoding_cache_size() const {
+        return encoding_cache.size();
+    }
+
     /** Assemble an x86 program from assembly source code using the nasm assembler. */
     virtual SgUnsignedCharList assembleProgram(const std::string &source);
 
@@ -353,31 +376,35 @@ private:
     /** Returns the base field of a SIB byte. */
     static unsigned sib_base(uint8_t sib) { return sib & 0x7; }
     
+    /** Up to four operand definitions. Unused trailing slots are od_none. */
+    struct OperandList {
+        OperandDefn defns[4];
+        size_t size() const {
+            size_t n = 0;
+            while (n<4 && defns[n]!=od_none)
+                ++n;
+            return n;
+        }
+        OperandDefn operator[](size_t i) const {
+            return defns[i];
+        }
+    };
+
     /** Defines static characteristics of an instruction used by the assembler and disassembler. The @p opcode contains up to
      *  eight bytes, but leading zeros are not emitted during assembly (except when the opcode is zero, in which case a single
-     *  zero byte is emitted; see ADD). */
-    class InsnDefn {
-    public:
-        InsnDefn(const std::string &mnemonic, X86InstructionKind kind, unsigned compatibility, uint64_t opcode,
-                 unsigned opcode_modifiers, OperandDefn op1=od_none, OperandDefn op2=od_none, OperandDefn op3=od_none,
-                 OperandDefn op4=od_none)
-            : mnemonic(mnemonic), kind(kind), compatibility(compatibility), opcode(opcode), opcode_modifiers(opcode_modifiers) {
-            if (op1) operands.push_back(op1);
-            if (op2) operands.push_back(op2);
-            if (op3) operands.push_back(op3);
-            if (op4) operands.push_back(op4);
-        }
+     *  zero byte is emitted; see ADD).
+     *
+     *  This is a plain aggregate so that the generated definition tables are initialized statically, without running any code
+     *  or allocating memory when the program starts. */
+    struct InsnDefn {
         std::string to_str() const;
-        void set_location(const std::string &s) {
-            location = s;
-        }
-        std::string mnemonic;
+        const char *mnemonic;
         X86InstructionKind kind;
         unsigned compatibility;
         uint64_t opcode;
         unsigned opcode_modifiers;
-        std::vector<OperandDefn> operands;
-        std::string location;                           /* location of instruction documentation */
+        OperandList operands;
+        const char *location;                           /* location of instruction documentation */
     };
 
     enum MemoryReferencePattern 
@@ -392,28 +419,41 @@ private:
         mrp_base_index_disp             /* register + register*scale + displacement */
     };
 
-    /** Instruction assembly definitions for a single kind of instruction. */
-    typedef std::vector<const InsnDefn*> DictionaryPage;
+    /** Instruction assembly definitions for all kinds of instructions, grouped by X86InstructionKind. Within a kind, the
+     *  definitions are in the order they appear in the generated tables. */
+    typedef std::vector<const InsnDefn*> InsnDictionary;
+
+    /** Instruction assembly definitions that can match an instruction, indexed by the instruction's encoding signature (see
+     *  encoding_signature()). */
+    typedef std::map<std::vector<uint64_t>, std::vector<const InsnDefn*> > EncodingCache;
 
-    /** Instruction assembly definitions for all kinds of instructions. */
-    typedef std::map<X86InstructionKind, DictionaryPage> InsnDictionary;
+    /** Generated tables of instruction assembly definitions and their sizes. */
+    static const InsnDefn defns_part1[], defns_part2[], defns_part3[], defns_part4[], defns_part5[], defns_part6[],
+        defns_part7[], defns_part8[], defns_part9[];
+    static const size_t ndefns_part1, ndefns_part2, ndefns_part3, ndefns_part4, ndefns_part5, ndefns_part6, ndefns_part7,
+        ndefns_part8, ndefns_part9;
 
     /** Build the dictionary used by the x86 assemblers. All x86 assemblers share a common dictionary. */
+    static void build_dictionary();
+
+    /** Adds each of the generated tables to the assembly dictionary. Called by build_dictionary(). */
     static void initAssemblyRules();
-    static void initAssemblyRules_part1();
-    static void initAssemblyRules_part2();
-    static void initAssemblyRules_part3();
-    static void initAssemblyRules_part4();
-    static void initAssemblyRules_part5();
-    static void initAssemblyRules_part6();
-    static void initAssemblyRules_part7();
-    static void initAssemblyRules_part8();
-    static void initAssemblyRules_part9();
-
-    /** Adds a definition to the assembly dictionary. All x86 assemblers share a common dictionary. */
-    static void define(const InsnDefn *d) {
-        defns[d->kind].push_back(d);
+
+    /** Adds a table of definitions to the assembly dictionary. All x86 assemblers share a common dictionary. */
+    static void define(const InsnDefn *table, size_t n) {
+        for (size_t i=0; i<n; ++i)
+            defns.push_back(table+i);
     }
+
+    /** Returns a key that determines which dictionary definitions match an instruction (see matches()), or an empty vector if
+     *  the instruction has operands whose matching can't be summarized this way. The key consists of the instruction kind,
+     *  whether it's a 64-bit instruction, and for each operand its register, memory type, or the range of its value; two
+     *  instructions with the same key match the same definitions. */
+    std::vector<uint64_t> encoding_signature(SgAsmX86Instruction*) const;
+
+    /** Returns the dictionary definitions that match the instruction's kind and operands, using the encoding cache when
+     *  possible. */
+    const std::vector<const InsnDefn*> &candidate_definitions(SgAsmX86Instruction*);
     
     /** Returns the string version of the instruction kind sans "x86_" prefix. This is not necessarily the same as the
      *  mnemonic since occassionally multiple kinds will map to a single mnemonic (e.g., RET maps to both x86_ret and
@@ -463,7 +503,11 @@ private:
     uint8_t segment_override(SgAsmX86Instruction*);
 
     static InsnDictionary defns;                /**< Instruction assembly definitions organized by X86InstructionKind. */
+    static std::vector<size_t> defn_index;      /**< Definitions for kind K are defns[defn_index[K]] up to defn_index[K+1]. */
     bool honor_operand_types;                   /**< If true, operand types rather than values determine assembled form. */
+    bool use_encoding_cache;                    /**< If true, candidate definitions are cached by encoding signature. */
+    EncodingCache encoding_cache;               /**< Candidate definitions for each encoding signature. */
+    std::vector<const InsnDefn*> uncached_candidates; /**< Candidates for instructions that have no encoding signature. */
 };
 
 } // namespace
@@ -6,6 +6,7 @@
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/string.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <queue>
 
@@ -31,7 +32,12 @@ namespace BinaryAnalysis {
  *  one dictionary may return a different descriptor than "eax" looked up in a different dictionary (but not in ROSE-created
  *  dictinaries).  Components of the ROSE binary support that generate RegisterDescriptors provide a mechanism for obtaining
  *  (and possibly setting) the register dictionary.  For instance, the Disassembler class has get_registers() and
- *  set_registers() methods. */
+ *  set_registers() methods.
+ *
+ *  The dictionaries created by the ROSE library are never modified after they're created, and they have lookup tables that make
+ *  @ref lookup and @ref exists take constant time: a perfect hash of the register names and an array indexed by major and minor
+ *  numbers.  A dictionary that's copied from one of them and then extended by the user (or any other dictionary) is looked up
+ *  through its maps instead, until @ref buildLookupTables is called for it. */
 class RegisterDictionary {
 public:
     typedef std::map<std::string/*name*/, RegisterDescriptor> Entries;
@@ -145,9 +151,27 @@ public:
 
 private:
     typedef std::map<RegisterDescriptor, std::vector<std::string> > Reverse; // a descriptor can have more than one name
+
+    // Tables for looking up the entries of an unmodified dictionary.  Names are found with a hash-and-displace perfect hash:
+    // the hash of a name selects a bucket, and the bucket's displacement selects the only slot where the name can be.
+    // Descriptors are found by scanning the few descriptors that have the same major and minor numbers.
+    struct LookupTables {
+        uint64_t seed;                                  // seed for hashing names
+        std::vector<uint32_t> displacements;            // one per bucket; empty if the names aren't indexed
+        std::vector<const Entries::value_type*> slots;  // forward entries, or null
+        std::vector<size_t> majorCells;                 // cells for major M start at majorCells[M]; empty if not indexed
+        std::vector<size_t> cellDescriptors;            // descriptors for cell C start at cellDescriptors[C]
+        std::vector<std::pair<const RegisterDescriptor*, const std::string*> > descriptors; // reverse keys and latest names
+        LookupTables(): seed(0) {}
+    };
+
     std::string name; /*name of the dictionary, usually an architecture name like 'i386'*/
     Entries forward;
     Reverse reverse;
+    boost::shared_ptr<LookupTables> tables;             // null if the dictionary was modified since they were built
+
+    const std::string *latestName(const Reverse::value_type&) const;
+    const std::pair<const RegisterDescriptor*, const std::string*> *findIndexed(RegisterDescriptor) const;
 
 #ifdef ROSE_HAVE_BOOST_SERIALIZATION_LIB
 private:
@@ -155,6 +179,8 @@ private:
 
     template<class S>
     void serialize(S &s, const unsigned /*version*/) {
+        if (S::is_loading::value)
+            tables.reset();
         s & BOOST_SERIALIZATION_NVP(name);
         s & BOOST_SERIALIZATION_NVP(forward);
         s & BOOST_SERIALIZATION_NVP(reverse);
@@ -172,6 +198,10 @@ public:
         *this = other;
     }
 
+    /** Copies another dictionary.  The lookup tables refer to the entries of the dictionary that owns them, so the copy
+     *  builds its own if the other dictionary has them. */
+    RegisterDictionary& operator=(const RegisterDictionary&);
+
     /** Class method to choose an appropriate register dictionary for an instruction set architecture. Returns the best
      *  available register dictionary for any architecture. Returns the null pointer if no dictionary is appropriate.
      * @{ */
@@ -211,6 +241,10 @@ public:
      *  register into the dictionary using the new descriptor.  This method does exactly that. */
     void resize(const std::string &name, unsigned new_nbits);
 
+    /** Builds tables that make lookups by name and by descriptor take constant time.  The tables are discarded when the
+     *  dictionary is next modified. The dictionaries created by the ROSE library already have them. */
+    void buildLookupTables();
+
     /** Returns a descriptor for a given register name. Returns the null pointer if the name is not found. It is not possible
      *  to modify a descriptor in the dictionary because doing so would interfere with the dictionary's data structures for
      *  reverse lookups. */
@@ -247,6 +281,8 @@ public:
     Rose::BinaryAnalysis::RegisterParts getAllParts() const;
 
     /** Returns the list of all register definitions in the dictionary.
+     *
+     *  Since the non-const version allows the definitions to be changed, it discards the dictionary's lookup tables.
      * @{ */
     const Entries& get_registers() const;
     Entries& get_registers();
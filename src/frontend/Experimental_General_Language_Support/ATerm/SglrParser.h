@@ -0,0 +1,75 @@
+#ifndef SGLR_PARSER_H
+#define SGLR_PARSER_H
+
+#include <aterm2.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace ATermSupport {
+
+// Runs the SGLR parser (sglri) on source files and returns their parse trees as ATerms.
+//
+// The parser writes each parse tree to a temporary file in the binary ATerm format (BAF),
+// which is smaller and much faster to read than the textual format, and the file is removed
+// once it has been read.  Files passed to prefetch() are parsed in the background by up to
+// one parser process per processor while the caller translates the files parsed earlier;
+// parse() then only waits for the file's own parser, if it is still running.  The ATerm
+// library itself is only used by the calling thread.
+//
+// There is one parser per parse table and it lives until the end of the process, so the
+// parse table is located once rather than once per file.  When the process exits, parsers
+// that are still running are killed and the parse trees that were never read are removed.
+class SglrParser
+{
+ public:
+   // The parser for a parse table, run by the given sglri executable
+   static SglrParser* instance(const std::string & sglri, const std::string & parseTable);
+
+   // Starts parsing the files in the background.  Files that are already being parsed, or have
+   // already been parsed, are skipped.
+   void prefetch(const std::vector<std::string> & fileNames);
+
+   // Returns the parse tree of a file, or NULL if the file could not be parsed.  The file is
+   // parsed now unless it was prefetched.
+   ATerm parse(const std::string & fileName);
+
+   const std::string & get_parseTable() const { return pParseTable; }
+
+ private:
+   SglrParser(const std::string & sglri, const std::string & parseTable);
+   ~SglrParser();
+
+   // Deletes all parsers; registered with atexit()
+   static void deleteAll();
+
+   struct Job
+      {
+         pid_t       pid;           // running parser process, or zero
+         std::string output;        // temporary BAF file written by the parser
+         bool        done;          // the parser has exited
+         bool        failed;        // the parser could not be run or failed
+         Job() : pid(0), done(false), failed(false) {}
+      };
+
+   void startJob(const std::string & fileName, Job & job);
+   bool finishJob(Job & job, bool wait);
+   void startQueuedJobs();
+   void cancelJobs();
+
+   std::string pSglri;
+   std::string pParseTable;
+   size_t      pMaxRunning;
+   size_t      pRunning;
+   pid_t       pOwner;             // the process that started the parsers
+
+   std::map<std::string, Job> pJobs;   // by file name, until the file's parse tree is returned
+   std::deque<std::string>    pQueue;  // prefetched files that are waiting for a process
+};
+
+}  // namespace ATermSupport
+
+#endif
@@ -40,6 +40,13 @@ class FortranModuleInfo
        static SgModuleStatement*   getModule(std::string modName);
        static void                 addMapping(std::string modName,SgModuleStatement* modStmt);
 
+    // Makes the modules defined in a file of the current project available to the files
+    // processed after it, so that their USE statements don't re-read the modules' .rmod files.
+    // As with a module read from its .rmod file, a USE statement only imports the public
+    // entities of the module, leaving out those made private by PRIVATE statements (see
+    // isPubliclyAccessible()).
+       static void                 addModulesFromFile(SgFile* file);
+
        static std::string find_file_from_inputDirs(std::string name);
 
        static void set_inputDirs(SgProject* );
@@ -625,6 +625,7 @@ private:
     void init(const Partitioner&);
     void freeze() { isFrozen_ = true; semantics_.optionalPenultimateState = Sawyer::Nothing(); }
     void thaw() { isFrozen_ = false; }
+    void eraseDataBlock(const DataBlock::Ptr&);         // used when rolling back to a checkpoint
     BasicBlockSemantics undropSemanticsNS(const Partitioner&);
 };
 
@@ -433,13 +433,17 @@ public:
      *
      *  The specified partitioner and the binary analysis components of the AST are saved into the specified file, which is
      *  created if it doesn't exist and truncated if it does exist. The name should end with a ".rba" extension. The file can
-     *  be loaded by passing its name to the @ref partition function or by calling @ref loadPartitioner. */
+     *  be loaded by passing its name to the @ref partition function or by calling @ref loadPartitioner.
+     *
+     *  If the name ends with ".rbx" then an indexed file is written instead (see @ref IndexedSerialOutput), the @p fmt
+     *  argument is ignored, and the AST is not saved. */
     virtual void savePartitioner(const Partitioner&, const boost::filesystem::path&, SerialIo::Format fmt = SerialIo::BINARY);
 
     /** Load a partitioner and an AST from a file.
      *
      *  The specified RBA file is opened and read to create a new @ref Partitioner object and associated AST. The @ref
-     *  partition function also understands how to open RBA files. */
+     *  partition function also understands how to open RBA files. Indexed files written by @ref IndexedSerialOutput are
+     *  recognized by their contents; they restore only the partitioner. */
     virtual Partitioner loadPartitioner(const boost::filesystem::path&, SerialIo::Format fmt = SerialIo::BINARY);
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -499,6 +503,12 @@ public:
      *  @c frontend function. */
     virtual bool isRbaFile(const std::string&);
 
+    /** Determine whether a specimen is an indexed RBA file.
+     *
+     *  Returns true if the name looks like an indexed ROSE Binary Analysis file (see @ref IndexedSerialOutput). Indexed
+     *  files are also RBA files according to @ref isRbaFile. */
+    virtual bool isIndexedRbaFile(const std::string&);
+
     /** Determine whether a specimen name is a non-container.
      *
      *  Certain strings are recognized as special instructions for how to adjust a memory map and are not intended to be passed
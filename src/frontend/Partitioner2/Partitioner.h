@@ -261,21 +261,22 @@ namespace Partitioner2 {
  *
  * @section partitioner_provisional Provisional Detection
  *
- *  (This section is a placeholder for an idea that is not yet implemented.)
- *
  *  Sometimes one wants to ask the question "does a recursive disassembly starting at some particular address look reasonable?"
- *  and avoid making any changes if it doesn't.  This can be accomplished by creating a second "provisional" partitioner which
- *  is either in its initial empty state or a copy of the current partitioner, running the query, and examining the result.
- *  If the result looks reasonable, then the provisional partitioner can be assigned to the current partitioner.
- *
- *  When a partitioner is copied (by the copy constructor or by assignment) it makes a new copy of the CFG and the address
- *  mapping.  The new copy points to the same instructions and basic blocks as the original, but since both of these items are
- *  constant (other than basic block analysis results) they are sharing read-only information.
+ *  and avoid making any changes if it doesn't.  This can be accomplished by creating a @ref Partitioner::checkpoint
+ *  "checkpoint", running the query, and examining the result.  If the result looks reasonable then the checkpoint is @ref
+ *  Partitioner::commit "committed", otherwise the partitioner is @ref Partitioner::rollback "rolled back" to the state it had
+ *  when the checkpoint was created.
  *
- *  The cost of copying the CFG is linear in the number of vertices and edges.  The cost of copying the address map is linear
- *  in the number of instructions (or slightly more if instructions overlap).
+ *  While a checkpoint exists, the partitioner records how to undo each change it makes to the CFG, the AUM, the function
+ *  table, and the blocks and functions attached to them.  Creating a checkpoint takes constant time and rolling back takes
+ *  time proportional to the number of changes made since the checkpoint, regardless of the size of the specimen.
  *
- *  A more efficient mechanism might be developed in the future.
+ *  A second "provisional" partitioner which is a copy of the current partitioner can be used for the same purpose. When a
+ *  partitioner is copied (by the copy constructor or by assignment) it makes a new copy of the CFG and the address mapping.
+ *  The new copy points to the same instructions and basic blocks as the original, but since both of these items are constant
+ *  (other than basic block analysis results) they are sharing read-only information.  The cost of copying the CFG is linear
+ *  in the number of vertices and edges.  The cost of copying the address map is linear in the number of instructions (or
+ *  slightly more if instructions overlap).
  *
  * @section partitioner_function_boundaries Function Boundary Determination
  *
@@ -306,7 +307,52 @@ public:
 
     /** Map address to name. */
     typedef Sawyer::Container::Map<rose_addr_t, std::string> AddressNameMap;
-    
+
+private:
+    // One change recorded while a checkpoint exists, with what's needed to undo it. Vertices are identified by their type and
+    // (for basic blocks and placeholders) their address since rolling back may erase and re-insert them.
+    struct JournalEntry {
+        enum Action {
+            VERTEX_INSERTED,                            // placeholder vertex at address va was inserted
+            VERTEX_ERASED,                              // placeholder vertex with value "vertex" was erased
+            VERTEX_CHANGED,                             // value of the vertex at address va was "vertex"
+            EDGE_INSERTED,                              // edge from va to targetVa with value "edge" was inserted
+            EDGE_ERASED,                                // edge from va to targetVa with value "edge" was erased
+            EDGE_CHANGED,                               // edge from va to targetVa changed from "edge" to "newEdge"
+            INSN_INSERTED,                              // AUM instruction "insn" owned by "bblock" was inserted
+            INSN_ERASED,                                // AUM instruction "insn" owned by "bblock" was erased
+            DBLOCK_INSERTED,                            // AUM data block "odb" was inserted
+            DBLOCK_ERASED,                              // AUM data block "odb" was erased
+            FUNCTION_INSERTED,                          // "function" was inserted into the function table
+            FUNCTION_ERASED,                            // "function" was erased from the function table
+            BBLOCK_FROZEN, BBLOCK_THAWED,               // "bblock" changed its frozen state
+            DBLOCK_FROZEN, DBLOCK_THAWED,               // "dblock" changed its frozen state
+            FUNCTION_FROZEN, FUNCTION_THAWED,           // "function" changed its frozen state
+            DBLOCK_OWNER_ADDED, DBLOCK_OWNER_REMOVED,   // owner count of "dblock" was incremented or decremented
+            BBLOCK_DBLOCK_INSERTED,                     // "dblock" was added to "bblock"
+            FUNCTION_DBLOCK_INSERTED,                   // "dblock" was added to "function"
+            FUNCTION_BBLOCK_INSERTED,                   // basic block address va was added to "function"
+            BBLOCK_COMMENT_CHANGED,                     // comment of "bblock" was "text"
+            FUNCTION_NAME_CHANGED,                      // name of "function" was "text"
+            FUNCTION_COMMENT_CHANGED                    // comment of "function" was "text"
+        };
+
+        Action action;
+        VertexType vertexType, targetType;
+        rose_addr_t va, targetVa;
+        CfgVertex vertex;
+        CfgEdge edge, newEdge;
+        SgAsmInstruction *insn;
+        BasicBlock::Ptr bblock;
+        DataBlock::Ptr dblock;
+        OwnedDataBlock odb;
+        Function::Ptr function;
+        std::string text;
+
+        explicit JournalEntry(Action action)
+            : action(action), vertexType(V_BASIC_BLOCK), targetType(V_BASIC_BLOCK), va(0), targetVa(0), insn(NULL) {}
+    };
+
 private:
     BasePartitionerSettings settings_;                  // settings adjustable from the command-line
     Configuration config_;                              // configuration information about functions, blocks, etc.
@@ -342,6 +388,10 @@ private:
     Progress::Ptr progress_;                            // Progress reporter to update, or null
     mutable size_t cfgProgressTotal_;                   // Expected total for the CFG progress bar; initialized at first report
 
+    // Checkpoints. Changes are recorded in the journal only while at least one checkpoint exists.
+    std::vector<JournalEntry> journal_;                 // changes since the oldest checkpoint, oldest first
+    std::vector<size_t> checkpoints_;                   // journal size at each checkpoint, innermost last
+
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -451,7 +501,9 @@ public:
      *  Thread safety: Not thread safe. */
     bool isDefaultConstructed() const { return instructionProvider_ == NULL; }
 
-    /** Reset CFG/AUM to initial state. */
+    /** Reset CFG/AUM to initial state.
+     *
+     *  This also discards all checkpoints. */
     void clear() /*final*/;
 
     /** Configuration information.
@@ -2436,6 +2488,62 @@ public:
 
 
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //
+    //                                  Checkpoints
+    //
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+public:
+    /** Create a checkpoint.
+     *
+     *  The partitioner can later be restored to its current state by calling @ref rollback, or the checkpoint can be discarded
+     *  by calling @ref commit.  The state that's restored consists of the CFG, the AUM, the function table, and the frozen
+     *  state, ownership, and names of the basic blocks, data blocks, and functions that are attached to them.  It does not
+     *  include properties such as the configuration, the address names, or cached analysis results.
+     *
+     *  Checkpoints nest: @ref rollback and @ref commit apply to the most recently created checkpoint that has not been rolled
+     *  back or committed yet.  Creating a checkpoint takes constant time. While a checkpoint exists, each change is recorded
+     *  in a journal, which costs a small amount of time and memory per change.
+     *
+     *  Thread safety: Not thread safe. */
+    void checkpoint() /*final*/;
+
+    /** Restore the state at the most recent checkpoint.
+     *
+     *  Undoes all changes made since the most recent checkpoint, newest first, and discards that checkpoint. This takes time
+     *  proportional to the number of changes.  The CFG adjustment callbacks are invoked for each basic block and placeholder
+     *  that the rollback attaches or detaches, after the rollback is complete.  CFG vertex and edge iterators obtained since
+     *  the checkpoint should be considered invalid afterward; placeholders that were erased since the checkpoint are restored
+     *  as new vertices.
+     *
+     *  It is an error to call this when there are no checkpoints.
+     *
+     *  Thread safety: Not thread safe. */
+    void rollback() /*final*/;
+
+    /** Discard the most recent checkpoint and keep the changes.
+     *
+     *  The changes made since the checkpoint become part of the changes made since the enclosing checkpoint, if any.  When the
+     *  last checkpoint is committed, the partitioner stops recording changes.
+     *
+     *  It is an error to call this when there are no checkpoints.
+     *
+     *  Thread safety: Not thread safe. */
+    void commit() /*final*/;
+
+    /** Number of checkpoints that exist.
+     *
+     *  Thread safety: Not thread safe. */
+    size_t nCheckpoints() const /*final*/ { return checkpoints_.size(); }
+
+    /** Number of changes recorded since the oldest checkpoint.
+     *
+     *  Thread safety: Not thread safe. */
+    size_t nJournalEntries() const /*final*/ { return journal_.size(); }
+
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //
@@ -2491,6 +2599,43 @@ private:
 
     // Rebuild the vertexIndex_ and other cache-like data members from the control flow graph
     void rebuildVertexIndices();
+
+    // Journaled changes.  All changes to the CFG, vertex index, AUM, function table, and to the attached blocks and functions
+    // go through these so that rollback() can undo them.  They only record anything while a checkpoint exists.
+    bool isJournaling() const { return !checkpoints_.empty(); }
+    void journal(const JournalEntry&);
+    ControlFlowGraph::VertexIterator insertPlaceholderVertex(rose_addr_t startVa);
+    void erasePlaceholderVertex(const ControlFlowGraph::VertexIterator&);
+    CfgVertex& changeVertex(const ControlFlowGraph::VertexIterator&); // returns vertex value to be modified
+    ControlFlowGraph::EdgeIterator insertCfgEdge(const ControlFlowGraph::VertexIterator &source,
+                                                 const ControlFlowGraph::VertexIterator &target, const CfgEdge&);
+    void clearCfgOutEdges(const ControlFlowGraph::VertexIterator&);
+    void changeCfgEdge(const ControlFlowGraph::EdgeIterator&, const CfgEdge&);
+    void aumInsertInstruction(SgAsmInstruction*, const BasicBlock::Ptr&);
+    void aumEraseInstruction(SgAsmInstruction*, const BasicBlock::Ptr&);
+    void aumInsertDataBlock(const OwnedDataBlock&);
+    void aumEraseDataBlock(const DataBlock::Ptr&);
+    void insertFunctionTable(const Function::Ptr&);
+    void eraseFunctionTable(const Function::Ptr&);
+    void freeze(const BasicBlock::Ptr&);
+    void thaw(const BasicBlock::Ptr&);
+    void freeze(const DataBlock::Ptr&);
+    void thaw(const DataBlock::Ptr&);
+    void freeze(const Function::Ptr&);
+    void thaw(const Function::Ptr&);
+    void incrementOwnerCount(const DataBlock::Ptr&);
+    size_t decrementOwnerCount(const DataBlock::Ptr&);
+    bool insertDataBlock(const BasicBlock::Ptr&, const DataBlock::Ptr&);
+    bool insertDataBlock(const Function::Ptr&, const DataBlock::Ptr&);
+    bool insertBasicBlock(const Function::Ptr&, rose_addr_t bblockVa);
+    void changeComment(const BasicBlock::Ptr&, const std::string&);
+    void changeName(const Function::Ptr&, const std::string&);
+    void changeComment(const Function::Ptr&, const std::string&);
+
+    // Undo one journal entry during rollback.
+    void undo(const JournalEntry&);
+    ControlFlowGraph::VertexIterator journaledVertex(VertexType, rose_addr_t);
+    ControlFlowGraph::EdgeIterator journaledEdge(const JournalEntry&, const CfgEdge&);
 };
 
 } // namespace
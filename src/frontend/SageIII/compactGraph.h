@@ -0,0 +1,150 @@
+#ifndef COMPACT_GRAPH_H
+#define COMPACT_GRAPH_H
+
+#include <boost/unordered_map.hpp>
+#include <vector>
+
+class SgIncidenceDirectedGraph;
+class SgGraphNode;
+class SgDirectedGraphEdge;
+
+//! A read-only snapshot of an SgIncidenceDirectedGraph in compressed sparse row form.
+//!
+//! SgIncidenceDirectedGraph keeps its edges in hash multimaps keyed by node
+//! index, and computeEdgeSetOut(), getSuccessors() and similar functions
+//! probe them with equal_range() and build a new set on every call.  Graph
+//! algorithms that visit each node and edge many times (on call graphs,
+//! class hierarchies, SDGs) spend most of their time there.  A CompactGraph
+//! numbers the nodes of the graph densely from zero and stores the out and
+//! in edges of each node as contiguous ranges of node IDs, so that
+//! successors and predecessors are array slices.
+//!
+//! Nodes are numbered in the order of their SgGraphNode indices, and the
+//! out edges of a node in the order of their SgDirectedGraphEdge indices
+//! (the order in which they were created), so the numbering does not depend
+//! on the hash tables.
+//!
+//! The snapshot does not see later changes to the graph.  After edges or
+//! nodes are added or removed, refresh() rebuilds it.  This is not
+//! incremental: it re-reads and sorts the node and edge index maps, and
+//! looks up each node and each edge endpoint in a hash table, so it costs
+//! O(n log n + m log m) like the constructor.  If no node was removed it
+//! keeps the IDs of the existing nodes, so that arrays indexed by node ID
+//! stay valid, and new nodes get the next IDs.
+class ROSE_DLL_API CompactGraph {
+  public:
+  //! Dense node identifier, from zero to nNodes()-1
+  typedef unsigned int NodeId;
+  //! Dense edge identifier, from zero to nEdges()-1
+  typedef unsigned int EdgeId;
+
+  //! Identifier that refers to no node
+  static const NodeId INVALID_ID;
+
+  //! A contiguous range of node or edge IDs in one of the CSR arrays
+  class IdRange {
+    const unsigned int* begin_;
+    const unsigned int* end_;
+    public:
+    IdRange(const unsigned int* begin, const unsigned int* end): begin_(begin), end_(end) {}
+    const unsigned int* begin() const {return begin_;}
+    const unsigned int* end() const {return end_;}
+    size_t size() const {return end_ - begin_;}
+    bool empty() const {return begin_ == end_;}
+    unsigned int operator[](size_t i) const {return begin_[i];}
+  };
+
+  //! Build the snapshot of a graph
+  explicit CompactGraph(SgIncidenceDirectedGraph* graph);
+
+  //! The graph this is a snapshot of
+  SgIncidenceDirectedGraph* getGraph() const {return graph_;}
+
+  //! Number of nodes
+  size_t nNodes() const {return nodes_.size();}
+  //! Number of edges
+  size_t nEdges() const {return edges_.size();}
+
+  //! The graph node with the given ID
+  SgGraphNode* node(NodeId id) const {return nodes_[id];}
+  //! ID of a graph node, or INVALID_ID if it was not in the graph when the snapshot was taken
+  NodeId id(SgGraphNode* n) const;
+
+  //! The graph edge with the given ID
+  SgDirectedGraphEdge* edge(EdgeId id) const {return edges_[id];}
+  //! Source node of an edge
+  NodeId edgeSource(EdgeId id) const {return edgeSources_[id];}
+  //! Target node of an edge
+  NodeId edgeTarget(EdgeId id) const {return succTargets_[id];}
+
+  //! Successor nodes, one per out edge
+  IdRange successors(NodeId n) const {return range(succTargets_, succOffsets_, n);}
+  //! Predecessor nodes, one per in edge
+  IdRange predecessors(NodeId n) const {return range(predSources_, predOffsets_, n);}
+  //! Out edges of a node; they are numbered contiguously, so this range is
+  //! [firstOutEdge(n), firstOutEdge(n+1))
+  EdgeId firstOutEdge(NodeId n) const {return succOffsets_[n];}
+  //! In edges of a node, parallel to predecessors(n)
+  IdRange inEdges(NodeId n) const {return range(predEdges_, predOffsets_, n);}
+
+  //! Rebuild the snapshot from the current state of the graph, at the cost
+  //! of building a new one.  Returns false if the graph has the same nodes
+  //! and edges as before.
+  bool refresh();
+
+  private:
+  IdRange range(const std::vector<unsigned int>& targets, const std::vector<unsigned int>& offsets, NodeId n) const {
+    const unsigned int* base = targets.empty() ? NULL : &targets[0];
+    return IdRange(base + offsets[n], base + offsets[n + 1]);
+  }
+
+  void build(const std::vector<SgGraphNode*>& previousNodes);
+
+  SgIncidenceDirectedGraph* graph_;
+  std::vector<SgGraphNode*> nodes_;
+  boost::unordered_map<SgGraphNode*, NodeId> ids_;
+  std::vector<SgDirectedGraphEdge*> edges_;       // by edge ID, grouped by source node
+  std::vector<unsigned int> edgeSources_;
+  std::vector<unsigned int> succOffsets_, succTargets_;
+  std::vector<unsigned int> predOffsets_, predSources_, predEdges_;
+};
+
+//! Graph algorithms over CompactGraph snapshots.
+//!
+//! The algorithms that take a number of threads use zero for the hardware
+//! concurrency and run in the calling thread when ROSE is built without
+//! thread support.  Their results do not depend on the number of threads.
+namespace CompactGraphAlgorithms {
+
+  //! Breadth-first search from the sources, following out edges (or in
+  //! edges if reverse is set).  Returns the distance of each node from the
+  //! nearest source, or CompactGraph::INVALID_ID for unreachable nodes.  The
+  //! nodes of each level are expanded in parallel.
+  ROSE_DLL_API std::vector<unsigned int>
+  breadthFirstLevels(const CompactGraph& graph, const std::vector<CompactGraph::NodeId>& sources,
+                     bool reverse = false, size_t nThreads = 0);
+
+  //! Strongly connected components.  Returns the component number of each
+  //! node and sets nComponents; components are numbered in the order of
+  //! their lowest node ID.  Nodes that cannot be in a cycle are trimmed
+  //! first, the component of the node with the most in and out edges is
+  //! then found with parallel forward and backward searches, and the
+  //! remaining nodes are handled by Tarjan's algorithm.
+  ROSE_DLL_API std::vector<unsigned int>
+  stronglyConnectedComponents(const CompactGraph& graph, size_t& nComponents, size_t nThreads = 0);
+
+  //! Immediate dominators of the nodes reachable from root, following out
+  //! edges (or in edges, for post-dominators, if reverse is set).  The root
+  //! and unreachable nodes have CompactGraph::INVALID_ID.  Uses the
+  //! iterative algorithm of Cooper, Harvey and Kennedy.
+  ROSE_DLL_API std::vector<CompactGraph::NodeId>
+  immediateDominators(const CompactGraph& graph, CompactGraph::NodeId root, bool reverse = false);
+
+  //! immediateDominators() for several roots (e.g., the entry of each
+  //! function of a call graph), one root per thread at a time
+  ROSE_DLL_API std::vector<std::vector<CompactGraph::NodeId> >
+  immediateDominators(const CompactGraph& graph, const std::vector<CompactGraph::NodeId>& roots,
+                      bool reverse = false, size_t nThreads = 0);
+}
+
+#endif
@@ -3187,6 +3187,10 @@ SgFile::callFrontEnd()
 
           if (get_verbose() > 1)
                printf ("DONE: Generating a Fortran 90 module file (*.rmod) \n");
+
+       // Files processed later in this project can use these modules directly instead of reading the .rmod files just written
+       // (their USE statements import the same public entities either way).
+          FortranModuleInfo::addModulesFromFile(this);
         }
 #endif
 
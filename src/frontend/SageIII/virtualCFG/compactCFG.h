@@ -0,0 +1,168 @@
+#ifndef COMPACT_CFG_H
+#define COMPACT_CFG_H
+
+#include "virtualCFG.h"
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <utility>
+#include <vector>
+
+class SgFunctionDefinition;
+
+namespace VirtualCFG {
+
+  //! A materialized, read-only snapshot of the virtual CFG of one function.
+  //!
+  //! CFGNode::outEdges() and CFGNode::inEdges() recompute the edges of a node
+  //! on every call, which dominates the run time of dataflow analyses that
+  //! visit each node many times before reaching a fixpoint.  A CompactCFG
+  //! enumerates the CFG of a function once, numbers its nodes densely from
+  //! zero, and stores the edges in compressed sparse row (CSR) arrays, so
+  //! that successors and predecessors are contiguous ranges of node IDs.  It
+  //! also provides the interesting-node view (the same nodes as
+  //! InterestingNode, with edges that skip over uninteresting nodes) and a
+  //! reverse postorder numbering of the nodes reachable from the entry.
+  //!
+  //! Predecessors are computed by reversing the out edges, so the snapshot is
+  //! consistent even where CFGNode::inEdges() is not (see the Fortran note
+  //! in virtualCFG.h).
+  //!
+  //! Snapshots are usually obtained with forFunction(), which caches them per
+  //! function.  Each snapshot records the AST generation (see
+  //! SgNode::get_astGeneration) it was built from, and forFunction() rebuilds
+  //! it once the AST has changed.  The SageInterface transformations also
+  //! drop the snapshot of the function they modify right away.
+  class ROSE_DLL_API CompactCFG {
+    public:
+    //! Dense node identifier, from zero to nNodes()-1
+    typedef unsigned int NodeId;
+    //! Dense edge identifier, from zero to nEdges()-1
+    typedef unsigned int EdgeId;
+
+    //! Identifier that refers to no node
+    static const NodeId INVALID_ID;
+
+    //! A contiguous range of node or edge IDs in one of the CSR arrays
+    class IdRange {
+      const unsigned int* begin_;
+      const unsigned int* end_;
+      public:
+      IdRange(const unsigned int* begin, const unsigned int* end): begin_(begin), end_(end) {}
+      const unsigned int* begin() const {return begin_;}
+      const unsigned int* end() const {return end_;}
+      size_t size() const {return end_ - begin_;}
+      bool empty() const {return begin_ == end_;}
+      unsigned int operator[](size_t i) const {return begin_[i];}
+    };
+
+    //! Build the snapshot of the CFG of a function, from
+    //! cfgBeginningOfConstruct(function) to cfgEndOfConstruct(function)
+    explicit CompactCFG(SgFunctionDefinition* function);
+
+    //! The function whose CFG this is
+    SgFunctionDefinition* getFunction() const {return function_;}
+    //! The AST generation this snapshot was built from
+    size_t getAstGeneration() const {return astGeneration_;}
+
+    //! Number of nodes
+    size_t nNodes() const {return nodes_.size();}
+    //! Number of edges
+    size_t nEdges() const {return edges_.size();}
+
+    //! The node with the given ID
+    const CFGNode& node(NodeId id) const {return nodes_[id];}
+    //! ID of a node, or INVALID_ID if the node is not part of this CFG
+    NodeId id(const CFGNode& n) const;
+
+    //! ID of the beginning of the function
+    NodeId entry() const {return entry_;}
+    //! ID of the end of the function
+    NodeId exit() const {return exit_;}
+
+    //! The edge with the given ID
+    const CFGEdge& edge(EdgeId id) const {return edges_[id];}
+    //! The condition of an edge, computed once when building the snapshot
+    EdgeConditionKind condition(EdgeId id) const {return conditions_[id];}
+    //! Source node of an edge
+    NodeId edgeSource(EdgeId id) const {return edgeSources_[id];}
+    //! Target node of an edge
+    NodeId edgeTarget(EdgeId id) const {return succTargets_[id];}
+
+    //! Successor nodes, in the order of CFGNode::outEdges()
+    IdRange successors(NodeId n) const {return range(succTargets_, succOffsets_, n);}
+    //! Predecessor nodes
+    IdRange predecessors(NodeId n) const {return range(predSources_, predOffsets_, n);}
+    //! Out edges of a node; they are numbered contiguously, so this range is
+    //! [firstOutEdge(n), firstOutEdge(n+1))
+    EdgeId firstOutEdge(NodeId n) const {return succOffsets_[n];}
+    //! In edges of a node, parallel to predecessors(n)
+    IdRange inEdges(NodeId n) const {return range(predEdges_, predOffsets_, n);}
+
+    //! Whether a node is in the interesting-node view (CFGNode::isInteresting(),
+    //! plus the entry and exit nodes)
+    bool isInteresting(NodeId n) const {return interesting_[n] != 0;}
+    //! Interesting successors of an interesting node, reached through
+    //! uninteresting nodes as in InterestingNode::outEdges(); empty for
+    //! uninteresting nodes
+    IdRange interestingSuccessors(NodeId n) const {return range(iSuccTargets_, iSuccOffsets_, n);}
+    //! Interesting predecessors of an interesting node
+    IdRange interestingPredecessors(NodeId n) const {return range(iPredSources_, iPredOffsets_, n);}
+
+    //! Nodes reachable from the entry, in reverse postorder
+    const std::vector<NodeId>& reversePostOrder() const {return rpo_;}
+    //! Position of a node in reversePostOrder(), or INVALID_ID if the node is
+    //! not reachable from the entry
+    unsigned int rpoNumber(NodeId n) const {return rpoNumbers_[n];}
+
+    //! The cached snapshot of a function's CFG, built on first use and
+    //! rebuilt when the AST generation has changed since
+    static boost::shared_ptr<const CompactCFG> forFunction(SgFunctionDefinition* function);
+    //! Drop the cached snapshots of the functions that contain a modified node.
+    //! If the node is not inside a function, all snapshots are dropped.
+    static void invalidateCache(SgNode* modified);
+    //! Drop all cached snapshots
+    static void clearCache();
+
+    private:
+    typedef std::pair<SgNode*, unsigned int> NodeKey;
+
+    static IdRange range(const std::vector<unsigned int>& v, const std::vector<unsigned int>& offsets, NodeId n) {
+      const unsigned int* base = v.empty() ? NULL : &v[0];
+      return IdRange(base + offsets[n], base + offsets[n + 1]);
+    }
+
+    void buildNodesAndEdges();
+    void buildPredecessors();
+    void buildInterestingView();
+    void buildReversePostOrder();
+
+    SgFunctionDefinition* function_;
+    size_t astGeneration_;
+    NodeId entry_;
+    NodeId exit_;
+
+    std::vector<CFGNode> nodes_;
+    boost::unordered_map<NodeKey, NodeId> ids_;
+
+    std::vector<CFGEdge> edges_;                    // indexed by EdgeId, grouped by source
+    std::vector<EdgeConditionKind> conditions_;     // indexed by EdgeId
+    std::vector<NodeId> edgeSources_;               // indexed by EdgeId
+    std::vector<unsigned int> succOffsets_;         // nNodes+1 offsets into succTargets_ and edges_
+    std::vector<NodeId> succTargets_;               // indexed by EdgeId
+    std::vector<unsigned int> predOffsets_;         // nNodes+1 offsets into predSources_ and predEdges_
+    std::vector<NodeId> predSources_;
+    std::vector<EdgeId> predEdges_;
+
+    std::vector<unsigned char> interesting_;
+    std::vector<unsigned int> iSuccOffsets_;
+    std::vector<NodeId> iSuccTargets_;
+    std::vector<unsigned int> iPredOffsets_;
+    std::vector<NodeId> iPredSources_;
+
+    std::vector<NodeId> rpo_;
+    std::vector<unsigned int> rpoNumbers_;
+  };
+
+} // end namespace VirtualCFG
+
+#endif // COMPACT_CFG_H
@@ -13,7 +13,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/nvp.hpp>
+#include <boost/shared_ptr.hpp>
 #include <Sawyer/BiMap.h>
+#include <Sawyer/Optional.h>
 #include <Sawyer/SharedObject.h>
 #include <Sawyer/SharedPointer.h>
 #include <Sawyer/Synchronization.h>
@@ -302,7 +304,8 @@ public:
  *
  *  ConcreteExecutor objects are expected to be used in single-threaded applications. Supporting multi-threaded concrete
  *  executors would be difficult since calling fork[2] from multi-threaded C++ programs is fraught with danger. Therefore, none
- *  of the methods in this API are thread-safe. */
+ *  of the methods in this API are thread-safe unless a subclass documents otherwise. The @ref ExecutionManager runs concrete
+ *  tests in parallel only with executors whose @ref execute method is thread-safe, such as @ref LinuxExecutor. */
 class ConcreteExecutor: public Sawyer::SharedObject {
 public:
     /** Reference counting pointer to a @ref ConcreteExecutor. */
@@ -354,7 +357,10 @@ public:
 };
 
 
-/** Concrete executor for Linux ELF executables. */
+/** Concrete executor for Linux ELF executables.
+ *
+ *  Each test case is run in a child process. The @ref execute method is thread-safe, so multiple test cases can be run
+ *  concurrently from different threads. */
 class LinuxExecutor: public ConcreteExecutor {
 public:
     /** Reference counting pointer to a @ref LinuxExecutor. */
@@ -391,10 +397,12 @@ public:
 
 protected:
     bool useAddressRandomization_;                      // enable/disable address space randomization in the OS
+    size_t cpuTimeLimit_;                               // CPU time limit for each test in seconds, or zero
+    size_t memoryLimit_;                                // address space limit for each test in bytes, or zero
 
 protected:
     LinuxExecutor()
-        : useAddressRandomization_(false) {}
+        : useAddressRandomization_(false), cpuTimeLimit_(0), memoryLimit_(0) {}
 
 public:
     /** Allocating constructor. */
@@ -414,6 +422,25 @@ public:
     void useAddressRandomization(bool b) { useAddressRandomization_ = b; }
     /** @} */
 
+    /** Property: CPU time limit per test case.
+     *
+     *  Maximum number of seconds of CPU time that the specimen may use while running one test case. A specimen that exceeds
+     *  the limit is killed by the operating system and its exit status reflects that. Zero means no limit.
+     *
+     * @{ */
+    size_t cpuTimeLimit() const { return cpuTimeLimit_; }
+    void cpuTimeLimit(size_t seconds) { cpuTimeLimit_ = seconds; }
+    /** @} */
+
+    /** Property: Memory limit per test case.
+     *
+     *  Maximum size in bytes of the specimen's address space while running one test case. Zero means no limit.
+     *
+     * @{ */
+    size_t memoryLimit() const { return memoryLimit_; }
+    void memoryLimit(size_t nBytes) { memoryLimit_ = nBytes; }
+    /** @} */
+
     virtual
     ConcreteExecutor::Result*
     execute(const TestCase::Ptr&) ROSE_OVERRIDE;
@@ -781,6 +808,14 @@ public:
     * Thread safety: thread safe
     */
    void insertConcreteResults(const TestCase::Ptr &testCase, const ConcreteExecutor::Result& details);
+
+   /** updates many testcases in a single transaction.
+    *
+    * The concrete rank of each test case must already be set.
+    *
+    * Thread safety: thread safe
+    */
+   void insertConcreteResults(const std::vector<TestCase::Ptr> &testCases);
    
    /** tests if there are more test cases that require testing.
     * 
@@ -803,8 +838,27 @@ public:
     /** Reference counting pointer to an @ref ExecutionManager. */
     typedef Sawyer::SharedPointer<ExecutionManager> Ptr;
 
+    /** Settings to control how test cases are run. */
+    struct Settings {
+        /** Number of test cases to run concretely at the same time.
+         *
+         *  If not set, then the global "--threads" command-line switch is used. Zero means use the number of threads
+         *  supported by the hardware. */
+        Sawyer::Optional<size_t> nThreads;
+
+        /** Number of concrete results to save to the database per transaction. */
+        size_t batchSize;
+
+        Settings()
+            : batchSize(16) {}
+    };
+
 private:
+    class ConcreteWorkers;
+
     Database::Ptr database_;
+    Settings settings_;
+    boost::shared_ptr<ConcreteWorkers> concreteWorkers_; // non-null while concrete tests are running in the background
 
 protected:
     // Subclasses should implement allocating constructors
@@ -814,13 +868,22 @@ protected:
     }
 
 public:
-    virtual ~ExecutionManager() {}
+    virtual ~ExecutionManager();
 
     /** Property: Database.
      *
      *  The database used by this manager.  The database is set in the constructor and cannot be changed later. */
     Database::Ptr database() const;
 
+    /** Property: Settings.
+     *
+     *  The settings should be adjusted before calling @ref run.
+     *
+     * @{ */
+    const Settings& settings() const { return settings_; }
+    Settings& settings() { return settings_; }
+    /** @} */
+
     /** Next test case for concrete execution.
      *
      *  Returns up to @p n (default unlimited) test cases that need to be run concretely. A test case needs to be run
@@ -838,6 +901,12 @@ public:
      *  user defined and stored in the database in XML format, while the rank is duplicated in a floating point field. */
     virtual void insertConcreteResults(const TestCase::Ptr&, const ConcreteExecutor::Result &details);
 
+    /** Insert results of many concrete runs.
+     *
+     *  This is the batched form of @ref insertConcreteResults used by the concrete worker threads. The concrete rank of each
+     *  test case has already been set, and all the test cases are updated in a single database transaction. */
+    virtual void insertConcreteResults(const std::vector<TestCase::Ptr> &testCases);
+
     /** Next test case for concolic execution.
      *
      *  Returns up to @p n (default unlimited) test cases that need to be run concolically. A test case needs to be run
@@ -865,6 +934,23 @@ public:
      *  Runs concrete and concolic executors until the application is interrupted or there's nothing left to do. Subclasses
      *  will likely reimplement this method in order to do parallel processing, limit execution time, etc. */
     virtual void run() = 0;
+
+protected:
+    /** Start running test cases concretely in the background.
+     *
+     *  Starts worker threads (see @ref Settings::nThreads) that repeatedly take a pending test case, execute it with the
+     *  specified executor, and save its results in the database in batches of @ref Settings::batchSize. The workers also pick
+     *  up test cases that are added to the database while they run, and they stop when no test case is pending. The calling
+     *  thread is free to do other work, such as concolic testing, until it calls @ref waitForConcreteWorkers. The executor's
+     *  @ref ConcreteExecutor::execute "execute" method must be thread-safe when more than one thread is used. */
+    void startConcreteWorkers(const ConcreteExecutor::Ptr&);
+
+    /** Wait for the concrete workers to finish.
+     *
+     *  Blocks until the workers started by @ref startConcreteWorkers have finished, saves their remaining results, and returns
+     *  the number of test cases they ran. If a worker failed, then its exception is rethrown here as an @ref Exception. Returns
+     *  zero if no workers were started. */
+    size_t waitForConcreteWorkers();
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
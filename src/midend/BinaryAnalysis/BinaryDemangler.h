@@ -4,16 +4,37 @@
 namespace Rose {
 namespace BinaryAnalysis {
 
+/** Demangles C++ names.
+ *
+ *  Names are demangled in batches by @ref fillCache and the results are cached in this object. Itanium ABI names (the format
+ *  used by GNU and LLVM compilers) are demangled within this process, in parallel, when ROSE's C++ runtime provides a
+ *  demangler. Other formats, and all names when the in-process demangler is unavailable, are demangled by running the
+ *  external c++filt command.  Results can also be saved in a file that persists across runs; see @ref cacheFile. */
 class Demangler {
 public:
     typedef Sawyer::Container::Map<std::string /*mangled*/, std::string /*non-mangled*/> NameMap;
 
+    /** How names are demangled. */
+    enum Backend {
+        AUTO_BACKEND,                                   /**< In-process if it supports the @ref compiler format, else c++filt. */
+        INTERNAL_BACKEND,                               /**< In-process Itanium ABI demangler. */
+        CXXFILT_BACKEND                                 /**< External c++filt command. */
+    };
+
 private:
     boost::filesystem::path cxxFiltExe_;                // name or path of the c++filt command ($PATH is used to search)
     NameMap nameMap_;                                   // cache of de-mangled names
     std::string compiler_;                              // format of mangled names
+    Backend backend_;                                   // how to demangle names
+    Sawyer::Optional<size_t> nThreads_;                 // number of threads for the in-process demangler
+    boost::filesystem::path cacheFile_;                 // optional file holding names demangled by previous runs
+    boost::filesystem::path loadedCacheFile_;           // cache file that has been read into nameMap_
+    bool rewriteCacheFile_;                             // whether the loaded cache file was rejected and must be started over
 
 public:
+    Demangler()
+        : backend_(AUTO_BACKEND), rewriteCacheFile_(false) {}
+
     /** Property: Name of c++filt program.
      *
      *  This is the name of the c++filt command that gets run to convert mangled names to demangled names. If it's not an
@@ -46,10 +67,52 @@ public:
     void compiler(const std::string &s) { compiler_ = s; }
     /** @} */
 
+    /** Property: Demangling backend.
+     *
+     *  The default, @ref AUTO_BACKEND, uses the in-process demangler if it's available and the @ref compiler property is
+     *  empty, "auto", or "gnu-v3", and c++filt otherwise.  Requesting @ref INTERNAL_BACKEND when the in-process
+     *  demangler is not available causes @ref fillCache to throw an <code>std::runtime_error</code>.
+     *
+     * @{ */
+    Backend backend() const { return backend_; }
+    void backend(Backend b) { backend_ = b; }
+    /** @} */
+
+    /** Whether the in-process demangler is available.
+     *
+     *  Returns true if ROSE was compiled with a C++ runtime that provides the Itanium ABI demangler. */
+    static bool haveInternalBackend();
+
+    /** Property: Number of threads.
+     *
+     *  Number of threads used by the in-process demangler. If this property has no value, then the global "--threads" switch
+     *  is used.  Zero means use the hardware concurrency. The results do not depend on the number of threads.
+     *
+     * @{ */
+    const Sawyer::Optional<size_t>& nThreads() const { return nThreads_; }
+    void nThreads(const Sawyer::Optional<size_t> &n) { nThreads_ = n; }
+    /** @} */
+
+    /** Property: Persistent cache file.
+     *
+     *  If non-empty, names demangled by previous runs are read from this file the first time @ref fillCache is called, and
+     *  names demangled by @ref fillCache are appended to it, so that multiple runs (and multiple processes) on the same or
+     *  related specimens only demangle each name once.  The file has a header line followed by one line per name with the @ref
+     *  compiler format, the mangled name, the demangled name, and a checksum of the other three, separated by TAB characters.
+     *  Names cached for other formats are ignored.  A file that is truncated or corrupt (a wrong header, or a line that is not
+     *  terminated or doesn't match its checksum) is ignored as a whole, with a warning, and is replaced when names are next
+     *  appended.  Failure to read or write the file is not an error; the names are demangled as if there were no cache.
+     *
+     * @{ */
+    const boost::filesystem::path& cacheFile() const { return cacheFile_; }
+    void cacheFile(const boost::filesystem::path &p) { cacheFile_ = p; }
+    /** @} */
+
     /** Demangle lots of names.
      *
-     *  The most efficient way to invoke this analyzer is to provide it with as many names as possible. It will send them all
-     *  to the c++filt program (@ref cxxFiltExe property) all at once and cache the results to query later. */
+     *  The most efficient way to invoke this analyzer is to provide it with as many names as possible. Names that are not
+     *  already cached are demangled all at once, either in parallel by the in-process demangler or by sending them to the
+     *  c++filt program (@ref cxxFiltExe property), and the results are cached to query later. See @ref backend. */
     void fillCache(const std::vector<std::string> &mangledNames);
 
     /** Demangle one name.
@@ -74,6 +137,21 @@ public:
      *
      *  Adds (or modifies) the mangled/demangled pair to the cache. */
     void insert(const std::string &mangledName, const std::string &demangledName);
+
+private:
+    // Whether the in-process demangler should be used for the current settings.
+    bool useInternalBackend() const;
+
+    // Demangle names, returning one demangled name per mangled name. Names that can't be demangled are returned unchanged.
+    std::vector<std::string> demangleInternal(const std::vector<std::string> &mangledNames) const;
+    std::vector<std::string> demangleCxxFilt(const std::vector<std::string> &mangledNames) const;
+
+    // Read the cache file into the name map, and append newly demangled names to it.
+    void loadCacheFile();
+    void saveCacheFile(const std::vector<std::string> &mangledNames, const std::vector<std::string> &demangledNames);
+
+    // Format of mangled names as recorded in the cache file.
+    std::string cacheFormat() const;
 };
 
 } // namespace
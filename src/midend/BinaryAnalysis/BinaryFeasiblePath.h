@@ -8,6 +8,7 @@
 #include <Sawyer/CommandLine.h>
 #include <Sawyer/Message.h>
 #include <boost/filesystem/path.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace Rose {
 namespace BinaryAnalysis {
@@ -24,7 +25,8 @@ public:
     enum SearchMode {
         SEARCH_SINGLE_DFS,                              /**< Perform a depth first search. */
         SEARCH_SINGLE_BFS,                              /**< Perform a breadth first search. */
-        SEARCH_MULTI                                    /**< Blast everything at once to the SMT solver. */
+        SEARCH_MULTI,                                   /**< Blast everything at once to the SMT solver. */
+        SEARCH_PARALLEL                                 /**< Depth first search split across multiple threads. */
     };
 
     /** Organization of semantic memory. */
@@ -87,6 +89,7 @@ public:
         double kCycleCoefficient;                       /**< Coefficient for adjusting maxPathLengh during CFG cycles. */
         EdgeVisitOrder edgeVisitOrder;                  /**< Order in which to visit edges. */
         bool trackingCodeCoverage;                      /**< If set, track which block addresses are reached. */
+        Sawyer::Optional<size_t> nThreads;              /**< Threads for @ref SEARCH_PARALLEL; default is global "--threads". */
 
         // Null dereferences
         struct NullDeref {
@@ -258,6 +261,10 @@ private:
     Partitioner2::CfgConstVertexSet cfgEndAvoidVertices_;// CFG end-of-path and other avoidance vertices
     FunctionSummarizer::Ptr functionSummarizer_;        // user-defined function for handling function summaries
     AddressSet reachedBlockVas_;                        // basic block addresses reached during analysis
+    class ParallelSearch;
+    class SearchWorker;
+    struct InfeasibleCache;
+    boost::shared_ptr<InfeasibleCache> infeasibleCache_;// path prefixes proven infeasible by SEARCH_PARALLEL
     static Sawyer::Attribute::Id POST_STATE;            // stores semantic state after executing the insns for a vertex
     static Sawyer::Attribute::Id POST_INSN_LENGTH;      // path length in instructions at end of vertex
     static Sawyer::Attribute::Id EFFECTIVE_K;           // (double) effective maximimum path length
@@ -286,6 +293,7 @@ public:
         cfgAvoidEdges_.clear();
         cfgEndAvoidVertices_.clear();
         reachedBlockVas_.clear();
+        infeasibleCache_.reset();
     }
 
     /** Initialize diagnostic output. This is called automatically when ROSE is initialized. */
@@ -378,6 +386,15 @@ public:
     virtual bool
     shouldInline(const Partitioner2::CfgPath &path, const Partitioner2::ControlFlowGraph::ConstVertexIterator &cfgCallTarget);
 
+    /** Inputs that determine whether a path is feasible.
+     *
+     *  Returns a string that changes whenever something changes that could make a previously infeasible path prefix
+     *  feasible or vice versa: the partitioner, the @ref functionSummarizer, and the settings that affect path
+     *  constraints. Path prefixes proven infeasible by a @ref SEARCH_PARALLEL search are reused by later searches only if
+     *  this string is unchanged and the search starts from the same initial state (see @ref setInitialState). Subclasses
+     *  that compute feasibility from other inputs should append those inputs to the string. */
+    virtual std::string infeasibleCacheKey() const;
+
     /** Property: Function summary handling.
      *
      *  As an alternative to creating a subclass to override the @ref processFunctionSummary, this property can contain an
@@ -457,7 +474,15 @@ public:
     /** Find all feasible paths.
      *
      *  Searches for paths and calls the @p pathProcessor each time a feasible path is found. The space is explored using a
-     *  depth first search, and the search can be limited with various @ref settings. */
+     *  depth first search, and the search can be limited with various @ref settings.
+     *
+     *  If the search mode is @ref SEARCH_PARALLEL, then the search is split at branch vertices across multiple threads, each
+     *  with its own SMT solver and virtual CPU. The @p pathProcessor's @c found and @c nullDeref methods are still called
+     *  from one thread at a time and in depth first order, although they're called with copies of the path, CPU, and
+     *  solver. The @c memoryIo method is called immediately from the worker threads, one call at a time, and in no particular
+     *  order. Path prefixes that are proven infeasible are remembered and are not proven again by later parallel searches
+     *  with the same @ref infeasibleCacheKey and initial state. If a worker thread throws an exception (including exceptions
+     *  thrown by the @p pathProcessor), then the search is stopped and the first such exception is rethrown by this method. */
     void depthFirstSearch(PathProcessor &pathProcessor);
 
 
@@ -564,6 +589,27 @@ private:
 
     // Mark vertex as being reached
     void markAsReached(const Partitioner2::ControlFlowGraph::ConstVertexIterator&);
+
+    // How the exploration of part of the search space ended.
+    enum ExploreResult { EXPLORE_DONE, EXPLORE_UNREACHABLE, EXPLORE_BREAK };
+
+    // Explore the paths that extend the specified path, which must be initialized for the search as done by depthFirstSearch.
+    // The worker is null for sequential searches.
+    ExploreResult explorePaths(Partitioner2::CfgPath &path /*in,out*/, SmtSolver::Ptr &solver,
+                               InstructionSemantics2::BaseSemantics::DispatcherPtr &cpu,
+                               const InstructionSemantics2::BaseSemantics::StatePtr &originalState,
+                               const Partitioner2::ControlFlowGraph::ConstVertexIterator &pathsBeginVertex,
+                               const std::vector<Expression> &assertions, SymbolicExprParser &exprParser,
+                               PathProcessor &pathProcessor, size_t callId, size_t &graphId /*in,out*/,
+                               SearchWorker *worker);
+
+    // Parallel version of the search from one starting vertex.
+    ExploreResult parallelSearch(const Partitioner2::ControlFlowGraph::ConstVertexIterator &pathsBeginVertex,
+                                 const std::vector<Expression> &assertions, PathProcessor &pathProcessor, size_t callId,
+                                 size_t &graphId /*in,out*/);
+
+    // Create an SMT solver for searching paths.
+    SmtSolver::Ptr createSearchSolver() const;
 };
 
 } // namespace
@@ -2,18 +2,32 @@
 #define ROSE_BinaryAnalysis_MagicNumber_H
 
 #include <MemoryMap.h>
+#include <Sawyer/Map.h>
 
 namespace Rose {
 namespace BinaryAnalysis {
 
 /** Identifies magic numbers in binaries.
  *
- *  The analysis constructor parses and stores the system's magic(5) files, which is then reused for each query. */
+ *  The analysis constructor parses and stores the system's magic(5) files, which is then reused for each query.
+ *
+ *  When libmagic is not available, a built-in matcher is used instead. It parses the system's magic(5) text files once per
+ *  process (plus a small set of rules compiled into ROSE for common executable, archive, and firmware formats) into a rule
+ *  table indexed by offset and first expected octet, so each query only evaluates the few rules that could possibly match.
+ *  The built-in matcher supports the commonly used subset of magic(5), so its descriptions are sometimes less detailed than
+ *  those of file(1). */
 class MagicNumberDetails;
 
 class MagicNumber {
 public:
-    enum Mechanism { FAST, SLOW, NONE };
+    enum Mechanism { FAST, SLOW, NONE, BUILTIN };
+
+    /** Hard-coded limit for the number of bytes checked at once. */
+    static const size_t maxBytesLimit = 4096;
+
+    /** Number of bytes checked by libmagic and file(1) when @ref maxBytesToCheck is automatic. This is enough for the formats
+     *  that are identified by octets beyond the first few hundred, such as tar archives. */
+    static const size_t defaultMaxBytes = 1024;
 
 private:
     MagicNumberDetails *details_;
@@ -22,7 +36,7 @@ private:
 
 public:
     /** Create a magic number analyzer. */
-    MagicNumber(): details_(NULL), maxBytes_(256) {
+    MagicNumber(): details_(NULL), maxBytes_(0) {
         init();
     }
 
@@ -34,31 +48,55 @@ public:
      *
      *  @li If the libmagic library is available then that mechanism is used the the return value is @ref FAST.
      *
-     *  @li If libmagic is not available and this is a Unix machine, then the file(1) command is invoked on a temporary
-     *  file. The return value in this case is @ref SLOW.
+     *  @li If libmagic is not available then ROSE's built-in magic(5) matcher is used and the return value is @ref
+     *  BUILTIN. The matcher runs in-process and does not depend on libmagic or file(1).
      *
-     *  @li If this is Windows and the libmagic library is not available then the return value is NONE. In this case, all calls
-     *  to identify will throw a <code>std::runtime_error</code>.
+     *  @li The file(1) command can be invoked on a temporary file for each query on Unix machines by setting this property to
+     *  @ref SLOW. This is much slower than the other mechanisms.
      *
-     *  This property is read-only. */
+     *  @li If this property is set to @ref NONE then all calls to identify will throw a <code>std::runtime_error</code>.
+     *
+     *  Setting this property to a mechanism that is not available on this system throws a <code>std::runtime_error</code>.
+     *
+     * @{ */
     Mechanism mechanism() const { return mechanism_; }
+    void mechanism(Mechanism);
+    /** @} */
 
     /** Property: Max number of bytes to check at once.
      *
      *  This property is the maximum number of bytes that should be passed at once to the magic-number checking funtions.  The
-     *  library imposes a hard-coded limit, but the user may set this to a lower value to gain speed. Trying to set this to a
-     *  higher value than the hard-coded limit will result in using the hard-coded limit.
+     *  library imposes a hard-coded limit (@ref maxBytesLimit), but the user may set this to a lower value to gain speed. Trying
+     *  to set this to a higher value than the hard-coded limit will result in using the hard-coded limit.
+     *
+     *  Setting this property to zero (the default) chooses the limit automatically. For the @ref BUILTIN mechanism it is the
+     *  largest offset plus length examined by any rule at a fixed offset, so that every such rule can match (for instance,
+     *  tar archives are recognized by octets 257 through 262). For the other mechanisms it is @ref defaultMaxBytes. The
+     *  value returned by the getter is the limit actually used.
      *
      * @{ */
-    size_t maxBytesToCheck() const { return maxBytes_; }
+    size_t maxBytesToCheck() const;
     void maxBytesToCheck(size_t n) { maxBytes_ = n; }
     /** @} */
 
     /** Identify the magic number at the specified address. */
     std::string identify(const MemoryMap::Ptr&, rose_addr_t va) const;
 
+    /** Identify the magic numbers at many addresses.
+     *
+     *  Returns one description per address, in the same order as the addresses. */
+    std::vector<std::string> identify(const MemoryMap::Ptr&, const std::vector<rose_addr_t> &vas) const;
+
+    /** Identify the magic number at the start of every page.
+     *
+     *  Every page of the memory map that has at least one mapped byte is identified, using the first mapped byte of the page
+     *  as the starting address. The pages are processed in parallel using the number of threads specified by the "threads"
+     *  command-line switch. The return value maps each starting address to its description. */
+    Sawyer::Container::Map<rose_addr_t, std::string> identifyPages(const MemoryMap::Ptr&, size_t pageSize = 4096) const;
+
 private:
     void init();
+    std::string identifyBuffer(const uint8_t *buf, size_t nBytes) const;
 };
 
 } // namespace
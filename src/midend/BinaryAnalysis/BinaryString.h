@@ -393,6 +393,12 @@ public:
     virtual State decode(Octet) ROSE_OVERRIDE;
     virtual CodeValue consume() ROSE_OVERRIDE;
     virtual void reset() ROSE_OVERRIDE;
+
+    /** Number of octets per code value. */
+    size_t octetsPerValue() const { return octetsPerValue_; }
+
+    /** Order of octets within a multi-octet code value. */
+    ByteOrder::Endianness byteOrder() const { return sex_; }
 };
 
 /** Returns a new basic character encoding scheme. */
@@ -467,6 +473,12 @@ public:
     virtual State decode(Octet) ROSE_OVERRIDE;
     virtual size_t consume() ROSE_OVERRIDE;
     virtual void reset() ROSE_OVERRIDE;
+
+    /** Number of octets per length value. */
+    size_t octetsPerValue() const { return octetsPerValue_; }
+
+    /** Order of octets within a multi-octet length value. */
+    ByteOrder::Endianness byteOrder() const { return sex_; }
 };
 
 /** Returns a new basic length encoding scheme. */
@@ -841,6 +853,13 @@ public:
          *  length, then removes any string whose memory addresses overlap with any prior string in the list. */
         bool keepingOnlyLongest;
 
+        /** Parallelism.
+         *
+         *  Number of threads used to search disjoint intervals of memory. Zero means use the hardware parallelism; unset means
+         *  use the global setting from the command-line. Searches that are anchored to a starting address always use a single
+         *  thread. */
+        Sawyer::Optional<size_t> nThreads;
+
         Settings(): minLength(5), maxLength(-1), maxOverlap(8), keepingOnlyLongest(true) {}
     };
     
@@ -938,6 +957,13 @@ public:
      *  each byte from memory only one time, simultaneously attempting all encoders.  If the MemoryMap constraint contains an
      *  anchor point (e.g., @ref MemoryMap::at) then only strings starting at the specified address are returned.
      *
+     *  Each contiguous interval of memory is searched independently, so the intervals are distributed across worker threads
+     *  according to the @ref Settings::nThreads "nThreads" setting. Encoders built from the basic parts provided by this
+     *  namespace (no-op character encoding form, basic character and length encoding schemes, and the @ref PrintableAscii or
+     *  @ref AnyCodePoint predicates) are searched with specialized scanners that skip memory that cannot contain a string;
+     *  other encoders are run octet by octet. Either way the results are the same as if every encoder had been run at every
+     *  address.
+     *
      *  Example 1: Find all C-style, NUL-terminated, ASCII strings contaiing only printable characters (no control characters)
      *  and containing at least five characters but not more than 31 (not counting the NUL terminator).  Make sure that the
      *  string is in memory that is readable but not writable, and don't allow strings to overlap one another (i.e., "foobar"
@@ -116,6 +116,18 @@ namespace LibraryIdentification
           **/
          bool matchLibrary(LibraryInfo& fInfo);
 
+         /** @brief Read all functions from the database at once.
+          *  Used to compile the database into a FunctionIdIndex.
+          *  @return Every function, with its signature if one was
+          *  stored
+          **/
+         std::vector<FunctionInfo> allFunctions();
+
+         /** @brief Read all libraries from the database at once.
+          *  @return Every library
+          **/
+         std::vector<LibraryInfo> allLibraries();
+
  private:
      // @brief The name of the database
      std::string database_name;
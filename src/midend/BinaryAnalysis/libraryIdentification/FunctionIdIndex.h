@@ -0,0 +1,171 @@
+#ifndef FUNCTION_ID_INDEX_H
+#define FUNCTION_ID_INDEX_H
+
+#include "LibraryInfo.h"
+#include "FunctionInfo.h"
+#include "libraryIdentification.h"
+#include <Sawyer/Optional.h>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <vector>
+
+/** LibraryIdentification.
+ *
+ *  This namespace encapsulates function for FLIRT ( Fast Library
+ *  Identification and Recognition Technology) like functionality for
+ *  ROSE binary analysis.
+ **/
+namespace LibraryIdentification
+{
+/** @class FunctionIdIndex
+ *
+ *  Read-only, memory-mapped form of a function identification
+ *  database.
+ *
+ *  Matching through FunctionIdDatabaseInterface issues one SQLite
+ *  query per function, which is far too slow for databases with
+ *  millions of functions.  Instead, the database can be compiled
+ *  once (see compile) into an index file that holds the function
+ *  records sorted by hash, the libraries sorted by hash, and the
+ *  FLIRT style signatures sorted by their masked four byte prefix.
+ *  Opening the index maps the file into memory without decoding
+ *  anything, and all lookups are binary searches, so one index can
+ *  be used by many threads at once.
+ **/
+    class FunctionIdIndex
+    {
+    public:
+        /** @brief Settings for matching a partitioner against the index
+         **/
+        struct Settings
+        {
+            //@brief Try signatures when no function has the same hash
+            bool fuzzy;
+
+            //@brief Minimum number of non-wildcard signature bytes
+            //for a fuzzy match.  Short signatures match too many
+            //unrelated functions.
+            size_t minSignatureBytes;
+
+            //@brief Number of threads; defaults to the global "threads"
+            //command-line switch.  Zero means use the hardware concurrency.
+            Sawyer::Optional<size_t> nThreads;
+
+            Settings(): fuzzy(true), minSignatureBytes(16) {}
+        };
+
+        //@brief Construct an index that is not open.
+        FunctionIdIndex();
+
+        //@brief Construct and open an index file.
+        explicit FunctionIdIndex(const std::string& indexName);
+
+        ~FunctionIdIndex();
+
+        /** @brief Compile a database into an index file.
+         *
+         *  Reads all functions, signatures, and libraries from the
+         *  database in bulk and writes them to a new index file.
+         *  @param[in] databaseName Existing function ID database
+         *  @param[in] indexName    Index file to create
+         *  @return Number of functions written
+         **/
+        static size_t compile(const std::string& databaseName, const std::string& indexName);
+
+        /** @brief Map an index file into memory.
+         *  Throws std::runtime_error if the file is not a valid index.
+         **/
+        void open(const std::string& indexName);
+
+        //@brief Unmap the index file.
+        void close();
+
+        //@brief True if an index file is open.
+        bool isOpen() const { return mapped_.is_open(); }
+
+        //@brief Number of functions in the index.
+        size_t nFunctions() const { return nFunctions_; }
+
+        //@brief Number of signatures in the index.
+        size_t nSignatures() const { return nSignatures_; }
+
+        //@brief Number of libraries in the index.
+        size_t nLibraries() const { return nLibraries_; }
+
+        /** @brief Lookup all functions with the hash.
+         *  @param[in] fInfo is used as a prototype for all the
+         *  returned FunctionInfos
+         *  @return A vector of all found functions
+         **/
+        std::vector<FunctionInfo> matchFunction(const FunctionInfo& fInfo) const;
+
+        /** @brief Lookup all functions whose signature matches the bytes.
+         *
+         *  A signature matches if every non-wildcard byte equals the
+         *  corresponding byte of the query, which must be at least as
+         *  long as the signature.  Only the most specific matches
+         *  (those with the most non-wildcard bytes) are returned.
+         *  @param[in] fInfo is used as a prototype for all the
+         *  returned FunctionInfos
+         *  @param[in] bytes The first bytes of the function being
+         *  identified
+         *  @param[in] minSignatureBytes Ignore signatures with fewer
+         *  non-wildcard bytes
+         **/
+        std::vector<FunctionInfo> fuzzyMatchFunction(const FunctionInfo& fInfo, const std::vector<uint8_t>& bytes,
+                                                     size_t minSignatureBytes) const;
+
+        /** @brief Lookup a library in the index.  True returned if found
+         *  @param[inout] lInfo The LibraryInfo only needs to
+         *  contain the hash, the rest will be filled in.
+         **/
+        bool matchLibrary(LibraryInfo& lInfo) const;
+
+    private:
+        struct FunctionRecord;
+        struct LibraryRecord;
+        struct SignatureRecord;
+        struct MaskGroup;
+
+        // not copyable
+        FunctionIdIndex(const FunctionIdIndex&);
+        FunctionIdIndex& operator=(const FunctionIdIndex&);
+
+        static bool parseSignature(const std::string& pattern, uint32_t function, SignatureRecord& rec);
+        static bool signatureLessThan(const SignatureRecord& a, const SignatureRecord& b);
+        std::string stringAt(uint32_t offset) const;
+        FunctionInfo functionInfo(const FunctionInfo& prototype, size_t idx) const;
+
+        boost::iostreams::mapped_file_source mapped_;
+        const FunctionRecord* functions_;
+        size_t nFunctions_;
+        const LibraryRecord* libraries_;
+        size_t nLibraries_;
+        const SignatureRecord* signatures_;
+        size_t nSignatures_;
+        const MaskGroup* maskGroups_;
+        size_t nMaskGroups_;
+        const char* strings_;
+        size_t stringsSize_;
+    };
+
+/** match functions in partitioner to a function ID index
+ *  This is the index equivalent of
+ *  matchLibraryIdentificationDataBase and returns the same map.
+ *  Functions are hashed and looked up in parallel, and when no
+ *  function in the index has the same hash, the function's first
+ *  bytes are optionally matched against the signatures, ignoring
+ *  the bytes that hold relocated addresses.
+ *
+ * @param[in] indexName    Index file created by FunctionIdIndex::compile
+ * @param[in] partitioner  Binary partitioner has the functions to find
+ * @param[in] settings     Matching settings
+ * @return libToFuncsMap Libraries->set(Functions) unmatched
+ * functions under "UNKNOWN", multimatched functions returned in
+ * "MULTIPLE_LIBS"
+ **/
+    LibToFuncsMap matchLibraryIdentificationIndex(const std::string& indexName,
+                                                  const Rose::BinaryAnalysis::Partitioner2::Partitioner& partitioner,
+                                                  const FunctionIdIndex::Settings& settings = FunctionIdIndex::Settings());
+}
+
+#endif
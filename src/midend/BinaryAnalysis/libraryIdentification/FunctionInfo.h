@@ -5,6 +5,7 @@
 #include "Combinatorics.h"
 #include <Partitioner2/Partitioner.h>
 #include <Partitioner2/Function.h>
+#include <boost/foreach.hpp>
 /** LibraryIdentification.
  *
  *  This namespace encapsulates function for FLIRT ( Fast Library
@@ -163,6 +164,14 @@ namespace LibraryIdentification
         //@brief A pointer to the binary version of this function IF
         //IT'S AVAILIBLE.  THIS IS LIKELY TO BE NULL
         Rose::BinaryAnalysis::Partitioner2::Function::Ptr binaryFunction;
+
+        //@brief FLIRT style byte pattern for the start of the
+        //function (see getSignature). Empty if not availible.
+        std::string signature;
+
+        //@brief The bytes described by signature, including those
+        //that the pattern replaces by wildcards.
+        std::vector<uint8_t> signatureBytes;
         
         static std::string getHash(const Rose::BinaryAnalysis::Partitioner2::Partitioner& partitioner, Rose::BinaryAnalysis::Partitioner2::Function::Ptr function) 
         {
@@ -183,11 +192,159 @@ namespace LibraryIdentification
         }
         
 
+        /**
+         *  getSignature
+         *
+         *  Returns a FLIRT style pattern for the first bytes of the
+         *  function: two hex digits per byte, with ".." in place of
+         *  bytes that probably hold addresses that the linker
+         *  relocates (absolute addresses and branch displacements).
+         *  Those bytes differ each time a library is linked into a
+         *  program, so they are ignored when matching.
+         *
+         * @param[in] partitioner Required to get the basic blocks of
+         * the function
+         * @param[in] function Binary AST Function Node
+         * @param[in] maxBytes Maximum length of the pattern in bytes
+         * @param[in] wildcards If false, no bytes are replaced by ".."
+         **/
+        static std::string getSignature(const Rose::BinaryAnalysis::Partitioner2::Partitioner& partitioner, Rose::BinaryAnalysis::Partitioner2::Function::Ptr function, size_t maxBytes = 32, bool wildcards = true)
+        {
+            std::vector<uint8_t> bytes;
+            std::vector<bool> variant;
+            collectSignature(partitioner, function, maxBytes, bytes, variant);
+            if(!wildcards)
+                variant.assign(variant.size(), false);
+            return formatSignature(bytes, variant);
+        }
+
+        /**
+         *  markEncodedValue
+         *
+         *  Marks the bytes of an instruction that encode a value
+         *  of the specified width (1, 2, 4, or 8 bytes) in either
+         *  byte order.  If tailOnly is set the value must be the
+         *  last bytes of the instruction, as branch displacements
+         *  are.  Values narrower than four bytes are too likely to
+         *  appear by chance, so only their last occurrence is marked
+         *  and never the first byte of the instruction (the opcode).
+         *
+         * @param[in] raw The instruction bytes
+         * @param[in] value The value, truncated to nBytes
+         * @param[in] nBytes Width of the encoded value
+         * @param[in,out] variant One flag per byte of raw
+         * @param[in] tailOnly Only look at the end of the instruction
+         **/
+        static void markEncodedValue(const SgUnsignedCharList& raw, uint64_t value, size_t nBytes, std::vector<bool>& variant,
+                                     bool tailOnly = false)
+        {
+            ROSE_ASSERT(nBytes == 1 || nBytes == 2 || nBytes == 4 || nBytes == 8);
+            ROSE_ASSERT(variant.size() == raw.size());
+            if(nBytes > raw.size())
+                return;
+            bool narrow = nBytes < 4;
+            size_t first = tailOnly ? raw.size() - nBytes : (narrow ? 1 : 0);
+            for(size_t order = 0; order < 2; ++order) 
+                {
+                    uint8_t encoded[8];
+                    for(size_t i = 0; i < nBytes; ++i)
+                        encoded[i] = (value >> (8 * (order ? nBytes - 1 - i : i))) & 0xff;
+                    for(size_t at = raw.size() - nBytes + 1; at > first; --at) 
+                        {
+                            if(std::equal(encoded, encoded + nBytes, raw.begin() + (at - 1))) 
+                                {
+                                    std::fill(variant.begin() + (at - 1), variant.begin() + (at - 1 + nBytes), true);
+                                    if(narrow)
+                                        break;
+                                }
+                        }
+                    if(1 == nBytes)
+                        break;                          // both byte orders are the same
+                }
+        }
+
     private:
         void initializeHash(const Rose::BinaryAnalysis::Partitioner2::Partitioner& partitioner, Rose::BinaryAnalysis::Partitioner2::Function::Ptr function) 
         {   //Ordered set, so it should always be the same order...
             funcHash = getHash(partitioner, function);
-            
+            std::vector<bool> variant;
+            collectSignature(partitioner, function, 32, signatureBytes, variant);
+            signature = formatSignature(signatureBytes, variant);
+        }
+
+        // Bytes from the start of the function following the fall-through path from the entry point, and which of those
+        // bytes are probably relocated.
+        static void collectSignature(const Rose::BinaryAnalysis::Partitioner2::Partitioner& partitioner, Rose::BinaryAnalysis::Partitioner2::Function::Ptr function, size_t maxBytes, std::vector<uint8_t>& bytes, std::vector<bool>& variant)
+        {
+            bytes.clear();
+            variant.clear();
+            rose_addr_t va = function->address();
+            while (bytes.size() < maxBytes && function->ownsBasicBlock(va)) 
+                {
+                    Rose::BinaryAnalysis::Partitioner2::BasicBlock::Ptr bb = partitioner.basicBlockExists(va);
+                    if(bb == NULL || bb->nInstructions() == 0)
+                        break;
+                    BOOST_FOREACH(SgAsmInstruction* insn, bb->instructions())
+                        appendInstructionBytes(bytes, variant, insn);
+                    if(bb->fallthroughVa() == va)
+                        break;
+                    va = bb->fallthroughVa();
+                }
+            if(bytes.size() > maxBytes) 
+                {
+                    bytes.resize(maxBytes);
+                    variant.resize(maxBytes);
+                }
+        }
+
+        static std::string formatSignature(const std::vector<uint8_t>& bytes, const std::vector<bool>& variant) 
+        {
+            std::string pattern;
+            for(size_t i = 0; i < bytes.size(); ++i) 
+                {
+                    if(variant[i]) 
+                        {
+                            pattern += "..";
+                        } 
+                    else 
+                        {
+                            static const char digits[] = "0123456789abcdef";
+                            pattern += digits[bytes[i] >> 4];
+                            pattern += digits[bytes[i] & 0xf];
+                        }
+                }
+            return pattern;
+        }
+
+        static void appendInstructionBytes(std::vector<uint8_t>& bytes, std::vector<bool>& variant, SgAsmInstruction* insn) 
+        {
+            const SgUnsignedCharList& raw = insn->get_raw_bytes();
+            std::vector<bool> insnVariant(raw.size(), false);
+            rose_addr_t fallthroughVa = insn->get_address() + raw.size();
+            BOOST_FOREACH(SgAsmIntegerValueExpression* ival, SageInterface::querySubTree<SgAsmIntegerValueExpression>(insn)) 
+                {   //Small constants are not addresses
+                    size_t nBits = ival->get_significantBits();
+                    uint64_t value = ival->get_absoluteValue();
+                    if(value < 0x10000)
+                        continue;
+                    if(nBits > 32)
+                        markEncodedValue(raw, value, 8, insnVariant);     // e.g., x86 imm64
+                    if(value <= 0xffffffff || (value >> 31) == 0x1ffffffffull)
+                        markEncodedValue(raw, value, 4, insnVariant);     // zero- or sign-extended 32 bits
+                }
+            rose_addr_t target = 0;
+            if(insn->getBranchTarget(&target)) 
+                {   //Displacements are relative to the fall-through address, and as short as the encoding allows
+                    int64_t displacement = (int64_t)(target - fallthroughVa);
+                    if(displacement >= -0x80 && displacement < 0x80)
+                        markEncodedValue(raw, displacement, 1, insnVariant, true);
+                    if(displacement >= -0x8000 && displacement < 0x8000)
+                        markEncodedValue(raw, displacement, 2, insnVariant, true);
+                    if(displacement >= -0x80000000LL && displacement < 0x80000000LL)
+                        markEncodedValue(raw, displacement, 4, insnVariant, true);
+                }
+            bytes.insert(bytes.end(), raw.begin(), raw.end());
+            variant.insert(variant.end(), insnVariant.begin(), insnVariant.end());
         }
 
     };
@@ -17,7 +17,7 @@ namespace AbstractHandle
 {
   // A helper function to convert SageType string to its enumerate type.
   // V_SgNumVariants is the last enum value of VariantT, which means no match is found.
-  static VariantT getVariantT(string type_str)
+  VariantT getVariantT(string type_str)
   {
     int i=0;
     string temp;
@@ -43,6 +43,9 @@ namespace AbstractHandle
 
   //! Convert an abstract handle string to a located node in AST
   ROSE_DLL_API SgLocatedNode* convertHandleToNode(const std::string& handle);
+
+  //! Convert a construct type name (with or without the 'Sg' prefix) to its variant, V_SgNumVariants if there is none
+  ROSE_DLL_API VariantT getVariantT(std::string type_str);
 }
 
 #endif
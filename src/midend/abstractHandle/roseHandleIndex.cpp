@@ -0,0 +1,354 @@
+#include "sage3basic.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "roseHandleIndex.h"
+
+using namespace std;
+
+namespace AbstractHandle
+{
+  static const int noFileId = INT_MIN;
+
+  // Records the nodes in the order of NodeQuery::querySubTree() (the query
+  // elements of each node in preorder) and the interval of positions spanned
+  // by each node's subtree.
+  class roseHandleIndex::Builder: public AstPrePostProcessing
+  {
+    public:
+      explicit Builder(roseHandleIndex* index): mIndex(index) {}
+
+      virtual void preOrderVisit(SgNode* node)
+      {
+        size_t begin = mIndex->mNodes.size();
+        if (!mIndex->mIntervals.insert(make_pair(node, Interval(begin, begin))).second)
+          mIndex->mShared.insert(node);
+        mBegin.push_back(begin);
+
+        mElements.clear();
+        NodeQuery::collectQueryElements(node, mElements);
+        for (Rose_STL_Container<SgNode*>::const_iterator i = mElements.begin(); i != mElements.end(); ++i)
+        {
+          size_t pos = mIndex->mNodes.size();
+          int variant = (*i)->variantT();
+          Sg_File_Info* file_info = (*i)->get_file_info();
+          int fileId = file_info != NULL ? file_info->get_file_id() : noFileId;
+          // same as roseNode::getStartPos()
+          size_t line = isSgLocatedNode(*i) ? isSgLocatedNode(*i)->get_file_info()->get_line() : 0;
+
+          mIndex->mNodes.push_back(*i);
+          mIndex->mFileIds.push_back(fileId);
+          mIndex->mByVariant[variant].push_back(pos);
+          mIndex->mByVariantFile[make_pair(variant, fileId)].push_back(pos);
+          mIndex->mByLine[make_pair(variant, line)].push_back(pos);
+        }
+      }
+
+      virtual void postOrderVisit(SgNode* node)
+      {
+        size_t begin = mBegin.back();
+        mBegin.pop_back();
+        Interval& interval = mIndex->mIntervals[node];
+        if (interval.first == begin)
+          interval.second = mIndex->mNodes.size();
+      }
+
+    private:
+      roseHandleIndex* mIndex;
+      vector<size_t> mBegin;
+      Rose_STL_Container<SgNode*> mElements;
+  };
+
+  roseHandleIndex::roseHandleIndex(SgNode* root)
+    : mRoot(root), mByVariant(V_SgNumVariants), mNamesIndexed(V_SgNumVariants, false), mSubclasses(V_SgNumVariants)
+  {
+    ROSE_ASSERT(root != NULL);
+    Builder builder(this);
+    builder.traverse(root);
+  }
+
+  bool roseHandleIndex::contains(SgNode* node) const
+  {
+    return mIntervals.find(node) != mIntervals.end();
+  }
+
+  // Nodes reached more than once have no single interval; they are handled by roseNode.
+  bool roseHandleIndex::getInterval(SgNode* node, Interval& interval) const
+  {
+    boost::unordered_map<SgNode*, Interval>::const_iterator found = mIntervals.find(node);
+    if (found == mIntervals.end() || mShared.find(node) != mShared.end())
+      return false;
+    interval = found->second;
+    return true;
+  }
+
+  VariantT roseHandleIndex::getVariant(const string& construct_type_str) const
+  {
+    boost::unordered_map<string, VariantT>::const_iterator found = mVariants.find(construct_type_str);
+    if (found != mVariants.end())
+      return found->second;
+    VariantT vt = getVariantT(construct_type_str);
+    mVariants[construct_type_str] = vt;
+    return vt;
+  }
+
+  // The variant and its subclasses, which are the node types querySubTree() returns for it
+  const VariantVector& roseHandleIndex::getSubclasses(VariantT vt) const
+  {
+    if (mSubclasses[vt].empty())
+      mSubclasses[vt] = VariantVector(vt);
+    return mSubclasses[vt];
+  }
+
+  void roseHandleIndex::indexNames(VariantT vt) const
+  {
+    if (mNamesIndexed[vt])
+      return;
+    const vector<size_t>& positions = mByVariant[vt];
+    for (vector<size_t>::const_iterator i = positions.begin(); i != positions.end(); ++i)
+      mByName[make_pair((int)vt, buildroseNode(mNodes[*i])->getName())].push_back(*i);
+    mNamesIndexed[vt] = true;
+  }
+
+  // Number of nodes of type vt or its subclasses in the same file that precede position pos in the scope
+  size_t roseHandleIndex::countPreceding(size_t pos, VariantT vt, int fileId, const Interval& scope) const
+  {
+    size_t count = 0;
+    const VariantVector& variants = getSubclasses(vt);
+    for (VariantVector::const_iterator v = variants.begin(); v != variants.end(); ++v)
+    {
+      boost::unordered_map<pair<int, int>, vector<size_t> >::const_iterator found = mByVariantFile.find(make_pair((int)*v, fileId));
+      if (found != mByVariantFile.end())
+        count += lower_bound(found->second.begin(), found->second.end(), pos) -
+                 lower_bound(found->second.begin(), found->second.end(), scope.first);
+    }
+    return count;
+  }
+
+  size_t roseHandleIndex::getNumbering(SgNode* node, SgNode* scope) const
+  {
+    ROSE_ASSERT(node != NULL);
+    // self is counted as number 1 if no parent node exists
+    if (scope == NULL)
+      return 1;
+    Interval nodeInterval, scopeInterval;
+    if (!getInterval(node, nodeInterval) || !getInterval(scope, scopeInterval) ||
+        nodeInterval.first < scopeInterval.first || nodeInterval.first >= scopeInterval.second)
+      return buildroseNode(node)->getNumbering(buildroseNode(scope));
+    return countPreceding(nodeInterval.first, node->variantT(), mFileIds[nodeInterval.first], scopeInterval) + 1;
+  }
+
+  SgNode* roseHandleIndex::findNode(SgNode* scope, const string& construct_type_str, specifier mspecifier) const
+  {
+    ROSE_ASSERT(scope != NULL);
+    VariantT vt = getVariant(construct_type_str);
+    // somehow the construct type str does not match any node types.
+    if (vt == V_SgNumVariants)
+      return NULL;
+
+    Interval range;
+    if (!getInterval(scope, range))
+    {
+      roseNode* result = dynamic_cast<roseNode*>(buildroseNode(scope)->findNode(construct_type_str, mspecifier));
+      return result != NULL ? (SgNode*) result->getNode() : NULL;
+    }
+
+    // The candidates of each variant are in querySubTree() order; the result
+    // is the first match over all variants, as in roseNode::findNode().
+    const VariantVector& variants = getSubclasses(vt);
+    size_t best = range.second;
+    if (mspecifier.get_type() == e_position)
+    {
+      source_position_pair positions = mspecifier.get_value().positions;
+      for (VariantVector::const_iterator v = variants.begin(); v != variants.end(); ++v)
+      {
+        boost::unordered_map<pair<int, size_t>, vector<size_t> >::const_iterator found =
+          mByLine.find(make_pair((int)*v, positions.first.line));
+        if (found == mByLine.end())
+          continue;
+        vector<size_t>::const_iterator i = lower_bound(found->second.begin(), found->second.end(), range.first);
+        for (; i != found->second.end() && *i < best; ++i)
+        {
+          if (isEqual(positions, buildroseNode(mNodes[*i])->getSourcePos()))
+          {
+            best = *i;
+            break;
+          }
+        }
+      }
+    }
+    else if (mspecifier.get_type() == e_name)
+    {
+      string name = mspecifier.get_value().str_v;
+      for (VariantVector::const_iterator v = variants.begin(); v != variants.end(); ++v)
+      {
+        if (mByVariant[*v].empty())
+          continue;
+        indexNames(*v);
+        boost::unordered_map<pair<int, string>, vector<size_t> >::const_iterator found = mByName.find(make_pair((int)*v, name));
+        if (found == mByName.end())
+          continue;
+        vector<size_t>::const_iterator i = lower_bound(found->second.begin(), found->second.end(), range.first);
+        if (i != found->second.end() && *i < best)
+          best = *i;
+      }
+    }
+    else if (mspecifier.get_type() == e_numbering)
+    {
+      size_t numbering = mspecifier.get_value().int_v;
+      vector<size_t> candidates;
+      for (VariantVector::const_iterator v = variants.begin(); v != variants.end(); ++v)
+      {
+        const vector<size_t>& positions = mByVariant[*v];
+        candidates.insert(candidates.end(),
+                          lower_bound(positions.begin(), positions.end(), range.first),
+                          lower_bound(positions.begin(), positions.end(), range.second));
+      }
+      sort(candidates.begin(), candidates.end());
+      for (vector<size_t>::const_iterator i = candidates.begin(); i != candidates.end(); ++i)
+      {
+        if (countPreceding(*i, mNodes[*i]->variantT(), mFileIds[*i], range) + 1 == numbering)
+        {
+          best = *i;
+          break;
+        }
+      }
+    }
+    else
+    {
+      cerr<<"error: unhandled specifier type in roseHandleIndex::findNode()"<<endl;
+      ROSE_ASSERT(false);
+    }
+
+    return best < range.second ? mNodes[best] : NULL;
+  }
+
+  SgNode* roseHandleIndex::findNode(SgNode* scope, const string& handle_item) const
+  {
+    pair<SgNode*, string> key(scope, handle_item);
+    boost::unordered_map<pair<SgNode*, string>, SgNode*>::const_iterator found = mResolved.find(key);
+    if (found != mResolved.end())
+      return found->second;
+
+    // same parsing as abstract_node::findNode(string)
+    ROSE_ASSERT(handle_item.size() > 0);
+    istringstream buffer(handle_item);
+    char type_str[256], specifier_str[PATH_MAX+512];
+    specifier mspecifier;
+    buffer.getline(type_str,256,'<');
+    buffer.unget(); // put back '<'
+    buffer.getline(specifier_str,PATH_MAX+512,'>');
+    fromString(mspecifier,specifier_str);
+
+    SgNode* result = findNode(scope, type_str, mspecifier);
+    mResolved[key] = result;
+    return result;
+  }
+
+  // Follows abstract_handle::fromString(): all items but the last are found
+  // within the file, and the last within the node of the item before it.
+  SgNode* roseHandleIndex::resolveInFile(SgSourceFile* file, const string& handle) const
+  {
+    vector<string> handle_str_vec;
+    istringstream buffer(handle);
+    char handle_item[256+PATH_MAX+512];
+    do {
+      buffer.getline(handle_item, 256+PATH_MAX+512, ':');
+      handle_str_vec.push_back(string(handle_item));
+      buffer.get();// skip the second ':'
+    } while (!buffer.eof());
+
+    SgNode* parent = file;
+    for (size_t i = 0; i + 1 < handle_str_vec.size(); i++)
+    {
+      parent = findNode(file, handle_str_vec[i]);
+      if (parent == NULL)
+        return NULL;
+    }
+    return findNode(parent, handle_str_vec.back());
+  }
+
+  SgLocatedNode* roseHandleIndex::convertHandleToNode(const string& handle) const
+  {
+    ROSE_ASSERT(handle.size() > 0);
+    const vector<size_t>& files = mByVariant[V_SgSourceFile];
+    for (vector<size_t>::const_iterator i = files.begin(); i != files.end(); ++i)
+    {
+      SgNode* target_node = resolveInFile(isSgSourceFile(mNodes[*i]), handle);
+      if (target_node != NULL)
+      {
+        ROSE_ASSERT(isSgStatement(target_node));
+        return isSgLocatedNode(target_node);
+      }
+    }
+    return NULL;
+  }
+
+  vector<SgLocatedNode*> roseHandleIndex::convertHandlesToNodes(const vector<string>& handles) const
+  {
+    vector<SgLocatedNode*> result;
+    result.reserve(handles.size());
+    for (vector<string>::const_iterator i = handles.begin(); i != handles.end(); ++i)
+      result.push_back(convertHandleToNode(*i));
+    return result;
+  }
+
+  // Same as buildSingleAbstractHandle() in roseAdapter.cpp, numbering snode within p_node
+  abstract_handle* roseHandleIndex::buildSingleAbstractHandle(SgNode* snode, SgNode* p_node, abstract_handle* p_handle) const
+  {
+    ROSE_ASSERT (snode != NULL);
+    abstract_node* anode = buildroseNode(snode);
+
+    // look up first
+    abstract_handle* result = handle_map[anode];
+    if (result != NULL)
+      return result;
+
+    if (isSgSourceFile (snode) || isSgProject(snode) ||isSgGlobal(snode))
+      result = new abstract_handle (anode);
+    else
+    {
+      ROSE_ASSERT (p_handle != NULL);
+      if (isSgFunctionDefinition(snode))
+        result = new abstract_handle (anode, e_name, p_handle);
+      else
+      {
+        specifier_value_t svalue;
+        svalue.int_v = getNumbering(snode, p_node);
+        result = new abstract_handle (anode, e_numbering, svalue, p_handle);
+      }
+    }
+
+    handle_map[anode] = result;
+    return result;
+  }
+
+  abstract_handle* roseHandleIndex::buildAbstractHandle(SgNode* snode) const
+  {
+    ROSE_ASSERT (snode != NULL);
+    if (isSgSourceFile (snode) || isSgProject(snode) ||isSgGlobal(snode))
+      return buildSingleAbstractHandle (snode, NULL, NULL);
+
+    // trace back to SgGlobal, storing all intermediate scopes
+    vector<SgNode*> scope_list;
+    SgScopeStatement* p_scope = SageInterface::getEnclosingScope(snode);
+    while (!isSgGlobal(p_scope))
+    {
+      scope_list.push_back(p_scope);
+      p_scope = SageInterface::getEnclosingScope(p_scope);
+    }
+
+    SgNode* p_node = p_scope;
+    abstract_handle* p_handle = buildSingleAbstractHandle (p_scope, NULL, NULL);
+    for (vector<SgNode*>::reverse_iterator riter = scope_list.rbegin(); riter != scope_list.rend(); riter++)
+    {
+      p_handle = buildSingleAbstractHandle (*riter, p_node, p_handle);
+      p_node = *riter;
+    }
+    return buildSingleAbstractHandle (snode, p_node, p_handle);
+  }
+}
@@ -0,0 +1,101 @@
+#ifndef rose_handle_index_INCLUDED
+#define rose_handle_index_INCLUDED
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "abstract_handle.h"
+#include "roseAdapter.h"
+
+namespace AbstractHandle
+{
+  //! An index of an AST for resolving and generating many abstract handles.
+  /*!
+   * roseNode::findNode() queries the whole subtree of the parent for every
+   * item of a handle and then compares names, positions or numberings one
+   * node at a time, and roseNode::getNumbering() queries the subtree of the
+   * scope again for every handle it numbers.  Resolving or generating
+   * thousands of handles this way is quadratic in the size of the AST.
+   *
+   * roseHandleIndex visits the AST once and records the nodes of each type
+   * in the order of NodeQuery::querySubTree(), together with their source
+   * lines and files, and the range of nodes in each subtree.  A handle item
+   * is then resolved by looking only at the nodes of the requested types in
+   * the scope (by line for position specifiers, by name for name
+   * specifiers), and resolved items are cached, so that handles sharing a
+   * prefix resolve it once.  The results are the same as those of
+   * roseNode::findNode(), convertHandleToNode() and buildAbstractHandle().
+   *
+   * The index is a snapshot: it must be rebuilt after the AST is modified.
+   * It is not thread safe, since names are indexed and items cached on
+   * first use.
+   *
+   * Example:
+   *   AbstractHandle::roseHandleIndex index(project);
+   *   std::vector<SgLocatedNode*> nodes = index.convertHandlesToNodes(handles);
+   *   std::string str = index.buildAbstractHandle(node)->toString();
+   */
+  class ROSE_DLL_API roseHandleIndex
+  {
+    public:
+      //! Build the index of the subtree rooted at root, usually the project
+      explicit roseHandleIndex(SgNode* root);
+
+      SgNode* getRoot() const {return mRoot;}
+
+      //! Whether node is in the indexed subtree
+      bool contains(SgNode* node) const;
+
+      //! Same as roseNode::findNode() on the scope node
+      SgNode* findNode(SgNode* scope, const std::string& construct_type_str, specifier mspecifier) const;
+
+      //! Same as roseNode::findNode(handle_str) on the scope node, for a single handle item such as ForStatement<numbering,2>
+      SgNode* findNode(SgNode* scope, const std::string& handle_item) const;
+
+      //! Same as roseNode::getNumbering() of node relative to scope
+      size_t getNumbering(SgNode* node, SgNode* scope) const;
+
+      //! Same as AbstractHandle::convertHandleToNode() for the files in the index
+      SgLocatedNode* convertHandleToNode(const std::string& handle) const;
+
+      //! Resolve a batch of handles, NULL for handles that are not found
+      std::vector<SgLocatedNode*> convertHandlesToNodes(const std::vector<std::string>& handles) const;
+
+      //! Same as AbstractHandle::buildAbstractHandle(), with numberings computed from the index.
+      //! Handles are cached in handle_map, so each node's handle is built once.
+      abstract_handle* buildAbstractHandle(SgNode* snode) const;
+
+    private:
+      class Builder;
+      typedef std::pair<size_t, size_t> Interval;       // [begin, end) positions of the nodes of a subtree
+
+      bool getInterval(SgNode* node, Interval& interval) const;
+      VariantT getVariant(const std::string& construct_type_str) const;
+      const VariantVector& getSubclasses(VariantT vt) const;
+      void indexNames(VariantT vt) const;
+      size_t countPreceding(size_t pos, VariantT vt, int fileId, const Interval& scope) const;
+      SgNode* resolveInFile(SgSourceFile* file, const std::string& handle) const;
+      abstract_handle* buildSingleAbstractHandle(SgNode* snode, SgNode* p_node, abstract_handle* p_handle) const;
+
+      SgNode* mRoot;
+      std::vector<SgNode*> mNodes;                                          // in querySubTree order
+      std::vector<int> mFileIds;                                           // per node
+      boost::unordered_map<SgNode*, Interval> mIntervals;
+      boost::unordered_set<SgNode*> mShared;                               // nodes reached more than once, e.g. types
+      std::vector<std::vector<size_t> > mByVariant;                        // variant -> positions
+      boost::unordered_map<std::pair<int, int>, std::vector<size_t> > mByVariantFile;        // (variant, file id) -> positions
+      boost::unordered_map<std::pair<int, size_t>, std::vector<size_t> > mByLine;            // (variant, line) -> positions
+
+      // built on first use
+      mutable std::vector<bool> mNamesIndexed;                                                  // per variant
+      mutable boost::unordered_map<std::pair<int, std::string>, std::vector<size_t> > mByName;   // (variant, name) -> positions
+      mutable std::vector<VariantVector> mSubclasses;                                           // per variant
+      mutable boost::unordered_map<std::string, VariantT> mVariants;                            // construct type name -> variant
+      mutable boost::unordered_map<std::pair<SgNode*, std::string>, SgNode*> mResolved;         // (scope, handle item) -> node
+  };
+}
+
+#endif
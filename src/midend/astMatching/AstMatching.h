@@ -41,6 +41,11 @@ class AstMatching {
   */
   void printMarkedLocations();
   bool performSingleMatch(SgNode* node, MatchOperationList* matchOperationSequence);
+  /* Parses a match expression and returns the sequence of match
+     operations that performs the match. Used by AstMultiMatching to
+     compile a set of patterns once.
+  */
+  static MatchOperationList* parseMatchExpression(std::string matchExpression);
  private:
   void performMatchingOnAst(SgNode* root);
   void performMatching();
@@ -0,0 +1,81 @@
+#ifndef AST_MULTI_MATCHING_H
+#define AST_MULTI_MATCHING_H
+
+#include "AstMatching.h"
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+class SgNode;
+
+/* Matches a set of patterns in a single traversal of the AST.
+
+   AstMatching parses its pattern on every call and tries it at every
+   node of the AST, hence a checker with N patterns performs N
+   traversals. AstMultiMatching parses each pattern once (addPattern)
+   and determines from its leading match operations the node types at
+   which it can succeed. During the traversal the patterns are
+   dispatched on the VariantT of each node, so a pattern is only tried
+   at nodes of the type its root names (or at all nodes for patterns
+   with a wildcard or variable at the root). The results are reported
+   per pattern and are the same as those of
+   AstMatching::performMatching for that pattern, including the
+   subtrees excluded by the '#' operator, which are excluded only for
+   the pattern that marked them.
+
+   Example:
+
+     AstMultiMatching m;
+     size_t assigns=m.addPattern("$R=SgAssignOp(SgVarRefExp,SgVarRefExp)");
+     size_t loops=m.addPattern("$FOR=SgForStatement(_,_,_,#_)");
+     m.performMatching(root);
+     MatchResult r1=m.getResult(assigns);
+     MatchResult r2=m.getResult(loops);
+*/
+class AstMultiMatching {
+ public:
+  AstMultiMatching();
+  ~AstMultiMatching();
+  /* Parses the match expression and adds it to the set of patterns.
+     Returns the index of the pattern that identifies its results.
+  */
+  size_t addPattern(std::string matchExpression);
+  size_t numberOfPatterns() const;
+  std::string getPattern(size_t patternIndex) const;
+  /* Matches all patterns on the AST rooted at root. Results of a
+     previous match are discarded.
+  */
+  void performMatching(SgNode* root);
+  /* Result of the last performMatching for one pattern. */
+  MatchResult getResult(size_t patternIndex);
+  /* Same as AstMatching::setKeepMarkedLocations: nodes marked with
+     '#' in a previous match remain excluded in subsequent matches.
+  */
+  void setKeepMarkedLocations(bool keepMarked);
+  /* This function is only for information purposes. It prints each
+     pattern with the node types at which it is tried.
+  */
+  void printPatterns();
+ private:
+  struct Pattern;
+  // not copyable
+  AstMultiMatching(const AstMultiMatching&);
+  AstMultiMatching& operator=(const AstMultiMatching&);
+
+  static void analyzeRoot(MatchOpSequence* sequence, Pattern* pattern);
+  const std::vector<size_t>& candidatePatterns(SgNode* node);
+  void performSingleMatch(size_t patternIndex, SgNode* node);
+
+ private:
+  std::vector<Pattern*> _patterns;
+  // patterns to try at a node, indexed by VariantT and computed on first use
+  std::vector<std::vector<size_t> > _dispatch;
+  std::vector<bool> _dispatchComputed;
+  // patterns to try at null values
+  std::vector<size_t> _nullCandidates;
+  // patterns that marked a node with '#'; the node's subtree is skipped for those patterns
+  boost::unordered_map<SgNode*, std::vector<size_t> > _markedBy;
+  bool _keepMarkedLocations;
+};
+
+#endif
@@ -82,6 +82,8 @@ class MatchOpOr : public MatchOperation {
  MatchOpOr(MatchOpSequence* l, MatchOpSequence* r):_left(l),_right(r){}
   std::string toString();
   bool performOperation(MatchStatus& status, RoseAst::iterator& i, SingleMatchResult& vb);
+  MatchOpSequence* left() const { return _left; }
+  MatchOpSequence* right() const { return _right; }
  private:
   MatchOpSequence* _left;
   MatchOpSequence* _right;
@@ -101,6 +103,8 @@ class MatchOpCheckNode : public MatchOperation {
   MatchOpCheckNode(std::string nodename);
   std::string toString();
   bool performOperation(MatchStatus&  status, RoseAst::iterator& i, SingleMatchResult& vb);
+  /* node type name in the format provided by typeid */
+  std::string nodeName() const { return _nodename; }
  private:
   std::string _nodename;
 };
@@ -187,6 +187,8 @@ namespace NodeQuery
   void pushNewNode ( NodeQuerySynthesizedAttributeType* nodeList, const VariantVector & targetVariantVector, SgNode * astNode);
   void* querySolverGrammarElementFromVariantVector ( SgNode * astNode, VariantVector targetVariantVector,  NodeQuerySynthesizedAttributeType* returnNodeList );
   NodeQuerySynthesizedAttributeType querySolverGrammarElementFromVariantVector ( SgNode * astNode, VariantVector targetVariantVector );
+  // Appends astNode and the non-traversed types that a variant query tests along with it (used by SubTreeIndex)
+  void collectQueryElements ( SgNode * astNode, Rose_STL_Container<SgNode*> & elements );
 
 
    /********************************************************************************************
@@ -0,0 +1,106 @@
+#ifndef ROSE_NODE_QUERY_INDEX_H
+#define ROSE_NODE_QUERY_INDEX_H
+
+#include "nodeQuery.h"
+#include "rosedll.h"
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <vector>
+
+namespace NodeQuery
+{
+
+  /**********************************************************************************************
+   * Variant index for NodeQuery::querySubTree.
+   *
+   * A variant query normally walks the whole subtree and tests every node, which is expensive
+   * when the same large AST is queried many times (e.g., once per function or per loop). This
+   * index walks the AST once and records, in traversal order, every node the query would test
+   * (including the non-traversed types that querySolverGrammarElementFromVariantVector adds).
+   * Each traversed node gets the half open interval of positions that belongs to its subtree, and
+   * each variant gets the sorted list of positions at which it occurs. A subtree query is then a
+   * binary search per requested variant followed by a copy of the k matches, i.e., O(log n + k),
+   * and returns the same nodes in the same order as the traversal.
+   *
+   * The index is a snapshot of one AST generation (see SgNode::get_astGeneration), and every
+   * query checks that the generation has not changed since the index was built. Any set_parent
+   * call that moves a node starts a new generation, as do the SageInterface transformations that
+   * only unlink nodes (removeStatement, deepDelete), so a stale index falls back to the traversal
+   * until it is rebuilt. Code that changes the AST without calling set_parent (e.g., erasing from
+   * a statement list by hand) must call SgNode::incrementAstGeneration or invalidate itself.
+   *
+   * Usage:
+   * @code
+   *   NodeQuery::SubTreeIndex index(project);
+   *   NodeQuery::SubTreeIndex::activate(&index);
+   *   ... NodeQuery::querySubTree(node, V_SgForStatement) now uses the index ...
+   *   NodeQuery::SubTreeIndex::activate(NULL);
+   * @endcode
+   *
+   * Queries are read-only and may be issued from several threads as long as no thread modifies
+   * the AST meanwhile: the AST generation counter is a plain unsynchronized integer, so a change
+   * made on another thread is not guaranteed to be seen by a query (nor is the AST itself safe to
+   * read while it changes). Building, invalidating and activating are not synchronized either.
+   *********************************************************************************************/
+  class ROSE_DLL_API SubTreeIndex
+     {
+       public:
+       // Build the index for the AST rooted at root.
+          explicit SubTreeIndex(SgNode* root);
+
+       // Rebuild the index, e.g., after it was invalidated by a transformation.
+          void rebuild();
+
+       // Discard the index contents; queries fall back to the traversal until rebuild is called.
+          void invalidate();
+
+       // True if the index has been built, not invalidated, and the AST has not changed since.
+          bool isValid() const;
+
+       // Root of the indexed AST.
+          SgNode* root() const { return root_; }
+
+       // Number of recorded query elements (nodes plus non-traversed types).
+          size_t size() const { return items_.size(); }
+
+       // True if subTree was visited exactly once when building the index, so its results can be answered from it.
+          bool contains(SgNode* subTree) const;
+
+       // Append to result all elements of subTree's query whose variant is in targetVariantVector, in the same
+       // order as querySubTree(subTree, targetVariantVector, AstQueryNamespace::AllNodes). Returns false, leaving
+       // result unchanged, if the index cannot answer the query.
+          bool query(SgNode* subTree, const VariantVector& targetVariantVector, NodeQuerySynthesizedAttributeType& result) const;
+
+       // Make index the one consulted by querySubTree, or pass NULL to stop using an index. The index is not owned.
+          static void activate(SubTreeIndex* index);
+
+       // The index consulted by querySubTree, or NULL.
+          static SubTreeIndex* active();
+
+       // Invalidate the active index, if any, and start a new AST generation so that every other index is stale too.
+       // Called by AST transformations.
+          static void invalidateActive();
+
+       private:
+          class Builder;
+
+          typedef std::pair<size_t, size_t> Interval;
+
+       // not copyable
+          SubTreeIndex(const SubTreeIndex&);
+          SubTreeIndex& operator=(const SubTreeIndex&);
+
+          SgNode* root_;
+          bool valid_;
+          size_t generation_;                                   // AST generation the index was built for
+          std::vector<SgNode*> items_;                          // query elements in traversal order
+          std::vector<std::vector<size_t> > positions_;         // per variant, sorted positions into items_
+          boost::unordered_map<SgNode*, Interval> intervals_;  // per traversed node, [begin,end) into items_
+          boost::unordered_set<SgNode*> shared_;               // nodes visited more than once
+
+          static SubTreeIndex* active_;
+     };
+
+}
+
+#endif
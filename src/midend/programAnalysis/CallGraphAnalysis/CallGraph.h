@@ -15,6 +15,7 @@
 #include <queue>
 #include <boost/foreach.hpp>
 #include <boost/unordered_map.hpp>
+#include <Sawyer/Synchronization.h>
 
 class FunctionData;
 
@@ -32,6 +33,8 @@ namespace CallTargetSet
 {
   typedef Rose_STL_Container<SgFunctionDeclaration *> SgFunctionDeclarationPtrList;
   typedef Rose_STL_Container<SgClassDefinition *> SgClassDefinitionPtrList;
+  class CallTargetIndex;
+
   // returns the list of declarations of all functions that may get called via the specified pointer
   std::vector<SgFunctionDeclaration*> solveFunctionPointerCall ( SgPointerDerefExp *, SgProject * );
 
@@ -40,9 +43,10 @@ namespace CallTargetSet
   Rose_STL_Container<SgFunctionDeclaration*> solveFunctionPointerCallsFunctional(SgNode* node, SgFunctionType* functionType );
 
   // returns the list of declarations of all functions that may get called via a
-  // member function (non/polymorphic) call
+  // member function (non/polymorphic) call; the overriders are taken from index when it is not NULL
   std::vector<SgFunctionDeclaration*> solveMemberFunctionCall ( 
-          SgClassType *, ClassHierarchyWrapper *, SgMemberFunctionDeclaration *, bool , bool includePureVirtualFunc = false );
+          SgClassType *, ClassHierarchyWrapper *, SgMemberFunctionDeclaration *, bool , bool includePureVirtualFunc = false,
+          CallTargetIndex *index = NULL );
 
   //! Returns the list of all constructors that may get called via an initialization.
   //! FIXME: There is a bug in this function. 
@@ -51,10 +55,12 @@ namespace CallTargetSet
   std::vector<SgFunctionDeclaration*> solveConstructorInitializer ( SgConstructorInitializer* sgCtorInit);
 
   // Populates functionList with Properties of all functions that may get called.
+  // Function pointer and virtual calls are resolved with index when it is not NULL.
   ROSE_DLL_API void getPropertiesForExpression(SgExpression* exp,
                                                ClassHierarchyWrapper* classHierarchy,
                                                Rose_STL_Container<SgFunctionDeclaration*>& propList,
-                                               bool includePureVirtualFunc = false);
+                                               bool includePureVirtualFunc = false,
+                                               CallTargetIndex* index = NULL);
 
   //! Populates functionList with definitions of all functions that may get called. This
   //! is basically a wrapper around getPropertiesForExpression that extracts the
@@ -83,6 +89,63 @@ namespace CallTargetSet
                                    SgMemberFunctionDeclaration *memberFunctionDeclaration, 
                                    ClassHierarchyWrapper *classHierarchy);
   
+
+  //! Call targets that depend only on types, computed once per project.
+  /*!
+   * Resolving a call through a function pointer compares the mangled type of every function
+   * declaration in the memory pool with the type of the pointer, and resolving a virtual call
+   * searches the members of all subclasses for overriders.  CallTargetIndex groups the function
+   * declarations by mangled type when it is constructed, and caches the overriders of each
+   * (class, virtual member function) pair the first time they are needed, so that this work is
+   * done once per project instead of once per call site.
+   *
+   * The index is a snapshot of the memory pool; build a new one after functions are added or
+   * removed.  Resolving a call may compute mangled names and expression types, which updates
+   * caches in the AST, so calls that will be looked up from several threads are resolved ahead of
+   * time, in one thread, with resolveAhead().  Looking up such a call only reads the index and
+   * takes no lock.  Other lookups are serialized by a mutex.
+   */
+  class ROSE_DLL_API CallTargetIndex
+  {
+    public:
+      explicit CallTargetIndex(ClassHierarchyWrapper* classHierarchy);
+
+      ClassHierarchyWrapper* getClassHierarchy() const { return classHierarchy; }
+
+      //! Function declarations with the same mangled type as type, in memory pool order.  These are
+      //! the declarations solveFunctionPointerCall() returns, or, if firstNondefiningOnly is set, the
+      //! ones that are their own first nondefining declaration.
+      const SgFunctionDeclarationPtrList& functionsOfType(SgFunctionType* type, bool firstNondefiningOnly);
+
+      //! Redeclarations of memberFunctionDeclaration in the subclasses of cls, as solveMemberFunctionCall() finds them
+      const std::vector<SgFunctionDeclaration*>& overriders(SgClassDefinition* cls,
+                                                           SgMemberFunctionDeclaration* memberFunctionDeclaration,
+                                                           bool includePureVirtualFunc);
+
+      //! Same as CallTargetSet::getPropertiesForExpression() with this index.  Calls resolved ahead of time are answered
+      //! without locking; the others are serialized with the other lookups.
+      void getPropertiesForExpression(SgExpression* exp, Rose_STL_Container<SgFunctionDeclaration*>& functionList,
+                                      bool includePureVirtualFunc = false);
+
+      //! Resolve calls (SgFunctionCallExp or SgConstructorInitializer) so that getPropertiesForExpression() can later
+      //! answer them from several threads at once.  Must not be called while other threads use the index.
+      void resolveAhead(const std::vector<SgExpression*>& exps, bool includePureVirtualFunc = false);
+
+    private:
+      typedef boost::unordered_map<std::string, SgFunctionDeclarationPtrList> FunctionsByType;
+      typedef std::pair<std::pair<SgClassDefinition*, SgMemberFunctionDeclaration*>, bool> OverriderKey;
+      typedef std::pair<SgExpression*, bool> ResolvedKey;
+
+      const std::string& typeKey(SgFunctionType* type);
+
+      ClassHierarchyWrapper* classHierarchy;
+      FunctionsByType functionsByType;                          // mangled type -> declarations
+      FunctionsByType firstNondefiningByType;                   // mangled type -> first nondefining declarations
+      boost::unordered_map<SgFunctionType*, std::string> typeKeys;
+      boost::unordered_map<OverriderKey, std::vector<SgFunctionDeclaration*> > overriderCache;
+      boost::unordered_map<ResolvedKey, std::vector<SgFunctionDeclaration*> > resolved;  // read-only once resolved ahead
+      SAWYER_THREAD_TRAITS::RecursiveMutex mutex;
+  };
 };
 
 class ROSE_DLL_API FunctionData
@@ -93,7 +156,10 @@ class ROSE_DLL_API FunctionData
 
     bool isDefined (); 
 
-    FunctionData(SgFunctionDeclaration* functionDeclaration, SgProject *project, ClassHierarchyWrapper * );
+    //! Computes the callees of functionDeclaration.  With an index, calls whose targets depend on types are resolved
+    //! through it, and the constructor may run in several threads at once for different functions.
+    FunctionData(SgFunctionDeclaration* functionDeclaration, SgProject *project, ClassHierarchyWrapper *,
+                 CallTargetSet::CallTargetIndex *index = NULL);
 
     //! All the callees of this function
     Rose_STL_Container<SgFunctionDeclaration *> functionList;
@@ -133,12 +199,26 @@ class ROSE_DLL_API CallGraphBuilder
     //We map each function to the corresponding graph node
     boost::unordered_map<SgFunctionDeclaration*, SgGraphNode*>& getGraphNodesMapping(){ return graphNodes; }
 
+    //! Number of threads computing the callees of the functions, zero (the default) for the hardware
+    //! concurrency.  The graph is the same for any number of threads.  Without thread support in
+    //! ROSE the callees are always computed in the calling thread.  If computing the callees of a
+    //! function throws, the other threads stop and buildCallGraph rethrows the exception.
+    void setNumberOfThreads(size_t n) { numberOfThreads = n; }
+    size_t getNumberOfThreads() const { return numberOfThreads; }
+
   private:
+    //! Computes the FunctionData of each function, in parallel, in the order of functions.  The calls that need the
+    //! index are resolved before the threads start.
+    std::vector<FunctionData> computeFunctionData(const std::vector<SgFunctionDeclaration*>& functions,
+                                                  ClassHierarchyWrapper* classHierarchy,
+                                                  CallTargetSet::CallTargetIndex* index);
+
     SgProject *project;
     SgIncidenceDirectedGraph *graph;
     //We map each function to the corresponding graph node
     typedef boost::unordered_map<SgFunctionDeclaration*, SgGraphNode*> GraphNodes;
     GraphNodes graphNodes;
+    size_t numberOfThreads;
 
 };
 //! Generate a dot graph named 'fileName' from a call graph 
@@ -177,7 +257,7 @@ CallGraphBuilder::buildCallGraph(Predicate pred)
     // Add nodes to the graph by querying the memory pool for function declarations, mapping them to unique declarations
     // that can be used as keys in a map (using get_firstNondefiningDeclaration()), and filtering according to the predicate.
     graph = new SgIncidenceDirectedGraph();
-    std::vector<FunctionData> callGraphData;
+    std::vector<SgFunctionDeclaration*> selectedFunctions;
     ClassHierarchyWrapper classHierarchy(project);
     graphNodes.clear();
     VariantVector vv(V_SgFunctionDeclaration);
@@ -192,11 +272,7 @@ CallGraphBuilder::buildCallGraph(Predicate pred)
 #endif
         if (isSelected(pred)(unique) && graphNodes.find(unique)==graphNodes.end()) 
            {
-#if 0
-            printf ("Collect function calls in unique function: unique = %p \n",unique);
-#endif
-            FunctionData fdata(unique, project, &classHierarchy); // computes functions called by unique
-            callGraphData.push_back(fdata);
+            selectedFunctions.push_back(unique);
             std::string functionName = unique->get_qualified_name().getString();
             SgGraphNode *graphNode = new SgGraphNode(functionName);
             graphNode->set_SgNode(unique);
@@ -213,6 +289,11 @@ CallGraphBuilder::buildCallGraph(Predicate pred)
           }
     }
 
+    // Compute the functions called by each selected function, with the call targets that depend on types indexed once
+    // for all of them, then add the edges in the order of the functions.
+    CallTargetSet::CallTargetIndex index(&classHierarchy);
+    std::vector<FunctionData> callGraphData = computeFunctionData(selectedFunctions, &classHierarchy, &index);
+
     // Add edges to the graph
     BOOST_FOREACH(FunctionData &currentFunction, callGraphData) {
         SgGraphNode *srcNode = graphNodes.find(currentFunction.functionDeclaration)->second; // we inserted it above
@@ -19,11 +19,11 @@ class DFAnalysis
   virtual int run(bool debug) = 0;
   // request information from the DFA
   
-  /** get the Definition multimap of a specific SgNode. */
-  virtual std::vector < std::pair <SgInitializedName* , SgNode*> >  getDefMultiMapFor(SgNode* node)=0;
+  /** get the Definition multimap of a specific SgNode. The reference is valid until the analysis changes. */
+  virtual const std::vector < std::pair <SgInitializedName* , SgNode*> >&  getDefMultiMapFor(SgNode* node)=0;
 
-  /** get the Usage multimap of a specific SgNode. */
-  virtual std::vector < std::pair <SgInitializedName* , SgNode*> >  getUseMultiMapFor(SgNode* node)=0;
+  /** get the Usage multimap of a specific SgNode. The reference is valid until the analysis changes. */
+  virtual const std::vector < std::pair <SgInitializedName* , SgNode*> >&  getUseMultiMapFor(SgNode* node)=0;
   
   /** get the vector of defining nodes for a specific node and a initializedName. */
   virtual std::vector < SgNode* > getDefFor(SgNode* node, SgInitializedName* initName)=0;
@@ -42,10 +42,10 @@ class DFAnalysis
   virtual int getIntForSgNode(SgNode* node)=0;
   virtual void dfaToDOT()=0;
 
-  virtual std::map< SgNode* , std::vector < std::pair <SgInitializedName* , SgNode*> > > getDefMap()=0;
-  virtual std::map< SgNode* , std::vector < std::pair <SgInitializedName* , SgNode*> > > getUseMap()=0;
-  virtual void setMaps(std::map< SgNode* , std::vector < std::pair <SgInitializedName* , SgNode*> > > def,
-                       std::map< SgNode* , std::vector < std::pair <SgInitializedName* , SgNode*> > > use)=0;
+  virtual const std::map< SgNode* , std::vector < std::pair <SgInitializedName* , SgNode*> > >& getDefMap()=0;
+  virtual const std::map< SgNode* , std::vector < std::pair <SgInitializedName* , SgNode*> > >& getUseMap()=0;
+  virtual void setMaps(const std::map< SgNode* , std::vector < std::pair <SgInitializedName* , SgNode*> > >& def,
+                       const std::map< SgNode* , std::vector < std::pair <SgInitializedName* , SgNode*> > >& use)=0;
 
 };
 
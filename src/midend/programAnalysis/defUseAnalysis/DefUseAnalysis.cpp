@@ -10,12 +10,36 @@
 #include "DefUseAnalysis_perFunction.h"
 #include "GlobalVarAnalysis.h"
 #include <boost/config.hpp>
-#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <Sawyer/Synchronization.h>
+#include <algorithm>
+#include <set>
 
 
 using namespace std;
-// static counter for the node numbering (for visualization)
-int DefUseAnalysis::sgNodeCounter = 1;
+
+namespace {
+  // Compares the entries of a node by variable only; the entries of one
+  // variable are contiguous since the entries are sorted.
+  struct CompareVariable {
+    bool operator()(const pair<SgInitializedName*, SgNode*>& a, SgInitializedName* b) const {
+      return a.first < b;
+    }
+    bool operator()(SgInitializedName* a, const pair<SgInitializedName*, SgNode*>& b) const {
+      return a < b.first;
+    }
+  };
+
+  // Restores the order of entries that did not come from this analysis
+  void sortEntries(map<SgNode*, vector<pair<SgInitializedName*, SgNode*> > >* tabl) {
+    typedef map<SgNode*, vector<pair<SgInitializedName*, SgNode*> > > tabletype;
+    for (tabletype::iterator i = tabl->begin(); i != tabl->end(); ++i) {
+      vector<pair<SgInitializedName*, SgNode*> >& multi = i->second;
+      sort(multi.begin(), multi.end());
+      multi.erase(unique(multi.begin(), multi.end()), multi.end());
+    }
+  }
+}
 
 
 /**********************************************************
@@ -90,20 +114,17 @@ void DefUseAnalysis::addAnyElement(tabletype* tabl, SgNode* sgNode,
 #if ROSE_GCC_OMP
 #pragma omp critical (DefUseAnalysisaddUseE) 
 #endif
+  {
   //  (*tabl)[sgNode].insert(make_pair(initName, defNode));
   std::pair<SgInitializedName*, SgNode*> el = make_pair(initName, defNode); 
-  multitype currentList = (*tabl)[sgNode];
-  if (find ( currentList.begin(), currentList.end(), el) == currentList.end())
+  multitype& currentList = (*tabl)[sgNode];
+  multitype::iterator pos = lower_bound(currentList.begin(), currentList.end(), el);
+  if (pos == currentList.end() || *pos != el)
   {
-    (*tabl)[sgNode].push_back(el);
+    currentList.insert(pos, el);
     addID(sgNode);
   }
-}
-
-bool DefUseAnalysismycond(std::pair<SgInitializedName*,SgNode* > n1, SgInitializedName* init) {
-  if (n1.first==init)
-    return true;
-  return false;
+  }
 }
 
 /**********************************************************
@@ -123,10 +144,10 @@ void DefUseAnalysis::replaceElement(SgNode* sgNode,
     //    table[sgNode].insert(make_pair(initName,sgNode));
 
     multitype& map = table[sgNode];
-    map.erase(std::remove_if(map.begin(), map.end(), boost::bind(boost::type<bool>(), DefUseAnalysismycond, _1, initName)), map.end());
+    pair<multitype::iterator, multitype::iterator> range = equal_range(map.begin(), map.end(), initName, CompareVariable());
     //         table[sgNode].erase(it);
 
-    table[sgNode].push_back(make_pair(initName,sgNode));
+    map.insert(map.erase(range.first, range.second), make_pair(initName,sgNode));
   }
 }
 
@@ -142,7 +163,8 @@ void DefUseAnalysis::clearUseOfElement(SgNode* sgNode,
   //  usetable[sgNode].erase(initName);
 
     multitype& map = usetable[sgNode];
-    map.erase(std::remove_if(map.begin(), map.end(), boost::bind(boost::type<bool>(), DefUseAnalysismycond, _1, initName)), map.end());
+    pair<multitype::iterator, multitype::iterator> range = equal_range(map.begin(), map.end(), initName, CompareVariable());
+    map.erase(range.first, range.second);
 
   }
 }
@@ -166,37 +188,64 @@ void DefUseAnalysis::mapUseUnion(SgNode* before, SgNode* other, SgNode* sgNode)
  *********************************************************/
 void DefUseAnalysis::mapAnyUnion(tabletype* tabl, SgNode* before, SgNode* other, SgNode* sgNode) {
   
-  bool beforeFound = true;
-  if ((*tabl).find(before)==(*tabl).end())
-    beforeFound = false;
-  bool otherFound = true;
-  if ((*tabl).find(other)==(*tabl).end())
-    otherFound = false;
+  tabletype::iterator beforeIt = (*tabl).find(before);
+  bool beforeFound = beforeIt != (*tabl).end();
+  tabletype::iterator otherIt = (*tabl).find(other);
+  bool otherFound = otherIt != (*tabl).end();
 
   addID(sgNode);
 
 #if ROSE_GCC_OMP
 #pragma omp critical (DefUseAnalysismapUse)
 #endif
+  {
+  multitype& current = (*tabl)[sgNode];
   if (!beforeFound) {
     if (!otherFound)
-      (*tabl)[sgNode].clear(); // both before and other nodes have empty sets
+      current.clear(); // both before and other nodes have empty sets
     else   // only other node has a set
-      (*tabl)[sgNode]=(*tabl)[other];
+      current = otherIt->second;
   } else {
     if (!otherFound)   // only before node has a set
-      (*tabl)[sgNode]=(*tabl)[before];
-    else {  // both has a set, perform the actual union operation : insert two sets into a single set
-      const multitype& multiA  = (*tabl)[before];
-      const multitype& multiB  = (*tabl)[other];
-      std::set<std::pair<SgInitializedName*, SgNode*> > s_before(multiA.begin(), multiA.end());
-       ROSE_ASSERT (s_before.size() == (*tabl)[before].size());
-
-      s_before.insert(multiB.begin(), multiB.end());
-      multitype multiC(s_before.begin(), s_before.end());
-      (*tabl)[sgNode].swap(multiC);
+      current = beforeIt->second;
+    else {  // both has a set, perform the actual union operation : merge the two sorted sets
+      const multitype& multiA  = beforeIt->second;
+      const multitype& multiB  = otherIt->second;
+      multitype multiC;
+      multiC.reserve(multiA.size() + multiB.size());
+      set_union(multiA.begin(), multiA.end(), multiB.begin(), multiB.end(), back_inserter(multiC));
+      current.swap(multiC);
     }
   }
+  }
+}
+
+/**********************************************************
+ *  Union of two tables, moving the entries of other
+ *********************************************************/
+void DefUseAnalysis::mergeAnyTable(tabletype* tabl, tabletype* other) {
+  for (tabletype::iterator i = other->begin(); i != other->end(); ++i) {
+    multitype& current = (*tabl)[i->first];
+    if (current.empty()) {
+      current.swap(i->second);
+    } else if (current != i->second) {
+      multitype merged;
+      merged.reserve(current.size() + i->second.size());
+      set_union(current.begin(), current.end(), i->second.begin(), i->second.end(), back_inserter(merged));
+      current.swap(merged);
+    }
+  }
+  other->clear();
+}
+
+/**********************************************************
+ *  Replace both tables; the entries of each node are sorted
+ *********************************************************/
+void DefUseAnalysis::setMaps(const tabletype& def, const tabletype& use) {
+  table = def;
+  usetable = use;
+  sortEntries(&table);
+  sortEntries(&usetable);
 }
 
 /**********************************************************
@@ -281,7 +330,7 @@ void DefUseAnalysis::printAnyMap(tabletype* tabl) {
     pos++;
     SgNode* sgNode = (*i).first;
     ROSE_ASSERT(sgNode);
-    multitype multi = (*i).second;
+    const multitype& multi = (*i).second;
     string name = getInitName(sgNode);
     int theNode = getIntForSgNode(sgNode);
     cout<<"........................."<<endl;
@@ -373,8 +422,7 @@ bool DefUseAnalysis::searchMap(const tabletype* ltable, SgNode* node) {
  * for any given node and initName, return all reaching definitions
  *****************************************/
 std::vector < SgNode* > DefUseAnalysis::getDefFor(SgNode* node, SgInitializedName* initName) {
-  multitype multi = getDefMultiMapFor(node);
-  return getAnyFor( &multi, initName); 
+  return getAnyFor( &getDefMultiMapFor(node), initName); 
 }
 
 /******************************************
@@ -382,8 +430,7 @@ std::vector < SgNode* > DefUseAnalysis::getDefFor(SgNode* node, SgInitializedNam
  * for any given node and initName, return all definitions 
  *****************************************/
 std::vector < SgNode* > DefUseAnalysis::getUseFor(SgNode* node, SgInitializedName* initName) {
-  multitype multi = getUseMultiMapFor(node);
-  return getAnyFor(&multi, initName); 
+  return getAnyFor(&getUseMultiMapFor(node), initName); 
 }
 
 /******************************************
@@ -391,20 +438,13 @@ std::vector < SgNode* > DefUseAnalysis::getUseFor(SgNode* node, SgInitializedNam
  * for any given node and initName, return all definitions 
  *****************************************/
 std::vector < SgNode* > DefUseAnalysis::getAnyFor(const multitype* multi, SgInitializedName* initName) {
+  // the entries of initName are contiguous in the sorted list
   vector < SgNode*> defNodes;
-  defNodes.clear();
-  //multitype multi = getDefUseFor(node);
-  if (multi->size()>0) {
-    multitype::const_iterator i = multi->begin();
-    for (; i!=multi->end();++i) {
-      SgInitializedName* initNameMM = isSgInitializedName(i->first);
-      SgNode* thenode = i->second;
-      if (initName==initNameMM) {
-        // we have found the right node and right initName
-        defNodes.push_back(thenode);
-      }
-    }
-  }
+  pair<multitype::const_iterator, multitype::const_iterator> range =
+    equal_range(multi->begin(), multi->end(), initName, CompareVariable());
+  defNodes.reserve(range.second - range.first);
+  for (multitype::const_iterator i = range.first; i != range.second; ++i)
+    defNodes.push_back(i->second);
   return defNodes;
 }
 
@@ -412,26 +452,28 @@ std::vector < SgNode* > DefUseAnalysis::getAnyFor(const multitype* multi, SgInit
  * return multimap to user
  * for any given node, return all definitions 
  *****************************************/
-std::vector <std::pair < SgInitializedName* , SgNode*> > DefUseAnalysis::getDefMultiMapFor(SgNode* node) {
-  multitype multi;
-  if (searchMap(&table, node)==true) {
-    // multimap is contained
-    multi = table[node];
-  }
-  return multi;
+const std::vector <std::pair < SgInitializedName* , SgNode*> >& DefUseAnalysis::getDefMultiMapFor(SgNode* node) {
+  return getAnyMultiMapFor(&table, node);
 }
 
 /******************************************
  * return multimap to user
  * for any given node, return all definitions 
  *****************************************/
-std::vector <std::pair < SgInitializedName* , SgNode*> > DefUseAnalysis::getUseMultiMapFor(SgNode* node) {
-  multitype multi;
-  if (searchMap(&usetable, node)==true) {
-    // multimap is contained
-    multi = usetable[node];
-  }
-  return multi;
+const std::vector <std::pair < SgInitializedName* , SgNode*> >& DefUseAnalysis::getUseMultiMapFor(SgNode* node) {
+  return getAnyMultiMapFor(&usetable, node);
+}
+
+/******************************************
+ * return the entries of a node, or an empty
+ * list if the node is not in the table
+ *****************************************/
+const std::vector <std::pair < SgInitializedName* , SgNode*> >& DefUseAnalysis::getAnyMultiMapFor(const tabletype* tabl, SgNode* node) {
+  static const multitype empty;
+  tabletype::const_iterator i = tabl->find(node);
+  if (i == tabl->end())
+    return empty;
+  return i->second;
 }
 
 /******************************************
@@ -484,6 +526,14 @@ bool  DefUseAnalysis::start_traversal_of_functions() {
 
   // Traverse through each FunctionDefinition and check for DefUse
   Rose_STL_Container<SgNode*> functions = NodeQuery::querySubTree(project, V_SgFunctionDefinition); 
+
+  size_t nThreads = numberOfThreads > 0 ? numberOfThreads : std::max(1u, boost::thread::hardware_concurrency());
+#if !SAWYER_MULTI_THREADED
+  nThreads = 1;
+#endif
+  if (nThreads > 1 && !DEBUG_MODE)
+    return start_parallel_traversal_of_functions(functions, nThreads);
+
   DefUseAnalysisPF* defuse_perfunc = new DefUseAnalysisPF(DEBUG_MODE, this);
   bool abortme=false;
   for (Rose_STL_Container<SgNode*>::const_iterator i = functions.begin(); i != functions.end(); ++i) {
@@ -507,6 +557,176 @@ bool  DefUseAnalysis::start_traversal_of_functions() {
   return abortme;  
 }
 
+/******************************************
+ * Worker for the parallel traversal: takes the next function not yet
+ * taken and analyzes it in a DefUseAnalysis of its own that starts from
+ * the global variable entries (the tables before any function was
+ * analyzed). The results are merged in function order
+ * by whichever worker completes the function that is next in order.
+ * That start is the one of the serial traversal only as long as the
+ * functions before do not define global variables, so the merging
+ * stops after the first function that does, and no further functions
+ * are taken; the rest are analyzed serially afterwards.
+ *****************************************/
+struct DefUseAnalysis::FunctionWorker {
+  DefUseAnalysis* dfa;
+  const tabletype& globalDefs;
+  const tabletype& globalUses;
+  const Rose_STL_Container<SgNode*>& functions;
+  const vector<string>& names;
+  vector<DefUseAnalysis*>& results;
+  vector<FilteredCFGNode<IsDFAFilter> >& sources;
+  vector<char>& definesGlobals;
+  vector<char>& aborts;
+  size_t& next;
+  size_t& nextToMerge;
+  bool& stopped;
+  SAWYER_THREAD_TRAITS::Mutex& mutex;
+
+  FunctionWorker(DefUseAnalysis* dfa, const tabletype& globalDefs, const tabletype& globalUses,
+                 const Rose_STL_Container<SgNode*>& functions, const vector<string>& names,
+                 vector<DefUseAnalysis*>& results, vector<FilteredCFGNode<IsDFAFilter> >& sources,
+                 vector<char>& definesGlobals, vector<char>& aborts,
+                 size_t& next, size_t& nextToMerge, bool& stopped, SAWYER_THREAD_TRAITS::Mutex& mutex)
+    : dfa(dfa), globalDefs(globalDefs), globalUses(globalUses), functions(functions), names(names), results(results), sources(sources),
+      definesGlobals(definesGlobals), aborts(aborts), next(next), nextToMerge(nextToMerge), stopped(stopped), mutex(mutex) {}
+
+  // whether the analysis of proc has a definition of a global variable within proc
+  static bool definesGlobalVariable(DefUseAnalysis* local, SgFunctionDefinition* proc) {
+    vector<SgInitializedName*> globals = local->globalVarList;
+    sort(globals.begin(), globals.end());
+    set<SgNode*> checked;
+    for (tabletype::const_iterator i = local->table.begin(); i != local->table.end(); ++i) {
+      for (multitype::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
+        if (!binary_search(globals.begin(), globals.end(), j->first) || !checked.insert(j->second).second)
+          continue;
+        for (SgNode* n = j->second; n != NULL; n = n->get_parent()) {
+          if (n == proc)
+            return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void operator()() {
+    while (true) {
+      size_t i;
+      {
+        SAWYER_THREAD_TRAITS::LockGuard lock(mutex);
+        if (stopped || next >= functions.size())
+          return;
+        i = next++;
+      }
+
+      SgFunctionDefinition* proc = isSgFunctionDefinition(functions[i]);
+      DefUseAnalysis* local = new DefUseAnalysis(dfa->project);
+      local->globalVarList = dfa->globalVarList;
+      local->table = globalDefs;
+      local->usetable = globalUses;
+
+      bool abortme = false;
+      DefUseAnalysisPF defuse_perfunc(false, local);
+      FilteredCFGNode<IsDFAFilter> rem_source = defuse_perfunc.run(proc, names[i], abortme);
+      local->nrOfNodesVisited = defuse_perfunc.getNumberOfNodesVisited();
+      bool defines = definesGlobalVariable(local, proc);
+
+      SAWYER_THREAD_TRAITS::LockGuard lock(mutex);
+      aborts[i] = abortme;
+      definesGlobals[i] = defines;
+      sources[i] = rem_source;
+      results[i] = local;
+      while (!stopped && nextToMerge < results.size() && results[nextToMerge] != NULL) {
+        dfa->mergeFunctionResults(results[nextToMerge]);
+        delete results[nextToMerge];
+        results[nextToMerge] = NULL;
+        stopped = definesGlobals[nextToMerge] != 0;
+        ++nextToMerge;
+      }
+    }
+  }
+};
+
+/******************************************
+ * Add the results of the analysis of one function, numbering
+ * its nodes in the order in which that analysis numbered them
+ *****************************************/
+void DefUseAnalysis::mergeFunctionResults(DefUseAnalysis* functionAnalysis) {
+  mergeAnyTable(&table, &functionAnalysis->table);
+  mergeAnyTable(&usetable, &functionAnalysis->usetable);
+
+  vector<pair<int, SgNode*> > ids;
+  ids.reserve(functionAnalysis->vizzhelp.size());
+  for (convtype::const_iterator i = functionAnalysis->vizzhelp.begin(); i != functionAnalysis->vizzhelp.end(); ++i)
+    ids.push_back(make_pair(i->second, i->first));
+  sort(ids.begin(), ids.end());
+  for (size_t i = 0; i < ids.size(); ++i)
+    addID(ids[i].second);
+
+  nrOfNodesVisited += functionAnalysis->nrOfNodesVisited;
+}
+
+/******************************************
+ * Traversal over all functions in several threads.
+ * Each function is analyzed on its own, starting from
+ * the global variable entries made before the functions
+ * are entered (see run()). This is what the serial
+ * traversal starts each function from until a function
+ * defines a global variable, so the functions from
+ * the first one after it are analyzed serially, and
+ * the results are the same as those of the serial
+ * traversal.
+ *****************************************/
+bool DefUseAnalysis::start_parallel_traversal_of_functions(const Rose_STL_Container<SgNode*>& functions, size_t nThreads) {
+  // The names are computed here since they unparse the parameter types,
+  // which is not thread safe
+  vector<string> names;
+  names.reserve(functions.size());
+  for (Rose_STL_Container<SgNode*>::const_iterator i = functions.begin(); i != functions.end(); ++i)
+    names.push_back(getFullName(isSgFunctionDefinition(*i)));
+
+  // copied since the tables change as the functions are merged
+  const tabletype globalDefs = table;
+  const tabletype globalUses = usetable;
+
+  vector<DefUseAnalysis*> results(functions.size(), NULL);
+  vector<FilteredCFGNode<IsDFAFilter> > sources(functions.size(), FilteredCFGNode<IsDFAFilter>(CFGNode(NULL, 0)));
+  vector<char> definesGlobals(functions.size(), 0), aborts(functions.size(), 0);
+  size_t next = 0, nextToMerge = 0;
+  bool stopped = false;
+  SAWYER_THREAD_TRAITS::Mutex mutex;
+  FunctionWorker worker(this, globalDefs, globalUses, functions, names, results, sources, definesGlobals, aborts,
+                        next, nextToMerge, stopped, mutex);
+
+  boost::thread_group threads;
+  for (size_t i = 0; i < std::min(nThreads, functions.size()); ++i)
+    threads.create_thread(worker);
+  threads.join_all();
+  ROSE_ASSERT(stopped || nextToMerge == functions.size());
+
+  // functions analyzed after the merging stopped started from the wrong global entries
+  for (size_t i = nextToMerge; i < results.size(); ++i)
+    delete results[i];
+
+  bool aborted = false;
+  for (size_t i = 0; i < nextToMerge; ++i) {
+    aborted = aborted || aborts[i];
+    if (sources[i].getNode() != NULL)
+      dfaFunctions.push_back(sources[i]);
+  }
+
+  DefUseAnalysisPF defuse_perfunc(false, this);
+  for (size_t i = nextToMerge; i < functions.size(); ++i) {
+    bool abortme = false;
+    FilteredCFGNode<IsDFAFilter> rem_source = defuse_perfunc.run(isSgFunctionDefinition(functions[i]), names[i], abortme);
+    nrOfNodesVisited += defuse_perfunc.getNumberOfNodesVisited();
+    aborted = aborted || abortme;
+    if (rem_source.getNode() != NULL)
+      dfaFunctions.push_back(rem_source);
+  }
+  return aborted;
+}
+
 /******************************************
  * Traversal over one function
  *****************************************/
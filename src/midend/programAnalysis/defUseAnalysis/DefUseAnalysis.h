@@ -66,6 +66,8 @@ class ROSE_DLL_API DefUseAnalysis : public DFAnalysis, Support {
   bool visualizationEnabled;
 
   // def-use-specific --------------------
+  // The entries of a node are kept sorted and free of duplicates, so that
+  // lookups are binary searches and unions are merges.
   typedef std::vector < std::pair<SgInitializedName* , SgNode*> > multitype;
   //  typedef std::multimap < SgInitializedName* , SgNode* > multitype;
 
@@ -83,6 +85,9 @@ class ROSE_DLL_API DefUseAnalysis : public DFAnalysis, Support {
   // local functions ---------------------
   void find_all_global_variables();
   bool start_traversal_of_functions();
+  bool start_parallel_traversal_of_functions(const Rose_STL_Container<SgNode*>& functions, size_t nThreads);
+  void mergeFunctionResults(DefUseAnalysis* functionAnalysis);
+  struct FunctionWorker;
   bool searchMap(const tabletype* ltable, SgNode* node);
   bool searchVizzMap(SgNode* node);
   std::string getInitName(SgNode* sgNode);
@@ -94,20 +99,24 @@ class ROSE_DLL_API DefUseAnalysis : public DFAnalysis, Support {
   //ideftype idefTable;
   // the helper table for visualization
   convtype vizzhelp;
-  static int sgNodeCounter ;
+  int sgNodeCounter ;
   int nrOfNodesVisited;
+  // threads for the traversal over the functions, see setNumberOfThreads()
+  size_t numberOfThreads;
 
   // functions to be printed in DFAtoDOT
   std::vector <FilteredCFGNode < IsDFAFilter > > dfaFunctions;
 
   void addAnyElement(tabletype* tabl, SgNode* sgNode, SgInitializedName* initName, SgNode* defNode);
   void mapAnyUnion(tabletype* tabl, SgNode* before, SgNode* other, SgNode* current); // current = before Union other
+  const multitype& getAnyMultiMapFor(const tabletype* tabl, SgNode* node);
+  void mergeAnyTable(tabletype* tabl, tabletype* other); // tabl = tabl Union other, other is emptied
   void printAnyMap(tabletype* tabl);
 
 
  public:
   DefUseAnalysis(SgProject* proj): project(proj), 
-    DEBUG_MODE(false), DEBUG_MODE_EXTRA(false){
+    DEBUG_MODE(false), DEBUG_MODE_EXTRA(false), sgNodeCounter(1), nrOfNodesVisited(0), numberOfThreads(1){
     //visualizationEnabled=true;
     //table.clear();
     //usetable.clear();
@@ -117,19 +126,26 @@ class ROSE_DLL_API DefUseAnalysis : public DFAnalysis, Support {
   };
   virtual ~DefUseAnalysis() {}
 
-  std::map< SgNode* , multitype  > getDefMap() { return table;}
-  std::map< SgNode* , multitype  > getUseMap() { return usetable;}
-  void setMaps(std::map< SgNode* , multitype  > def,
-          std::map< SgNode* , multitype > use) {
-    table = def;
-    usetable = use;
-  }
+  const std::map< SgNode* , multitype  >& getDefMap() { return table;}
+  const std::map< SgNode* , multitype  >& getUseMap() { return usetable;}
+  void setMaps(const std::map< SgNode* , multitype  >& def,
+          const std::map< SgNode* , multitype >& use);
+
+  // Number of threads for run(): zero means one per processor. The default
+  // is one. The functions are analyzed in parallel as long as the ones
+  // before them do not define global variables; from the first function
+  // after one that does, they are analyzed serially, since their global
+  // variable entries depend on it. The results are the same for any number
+  // of threads.
+  void setNumberOfThreads(size_t n) { numberOfThreads = n; }
+  size_t getNumberOfThreads() const { return numberOfThreads; }
        
   // def-use-public-functions -----------
   int run();
   int run(bool debug);
-  multitype getDefMultiMapFor(SgNode* node);
-  multitype  getUseMultiMapFor(SgNode* node);
+  const multitype& getDefMultiMapFor(SgNode* node);
+  const multitype& getUseMultiMapFor(SgNode* node);
+  // the entries of mul must be sorted, as the lists of the tables are
   std::vector < SgNode* > getAnyFor(const multitype* mul, SgInitializedName* initName);
   // for any given node, return all definitions of initName
   std::vector < SgNode* > getDefFor(SgNode* node, SgInitializedName* initName);
@@ -6,6 +6,7 @@
 // tps : Switching from rose.h to sage3 changed size from 17,5 MB to 7,2MB
 #include "sage3basic.h"
 #include "DefUseAnalysisAbstract.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -29,38 +30,20 @@ bool DefUseAnalysisAbstract::searchVector(vector <filteredCFGNodeType> done,
 
 /**********************************************************
  *  Search for the value and key in the multimap
+ *  (the entries of the DefUseAnalysis tables are sorted)
  *********************************************************/
 bool DefUseAnalysisAbstract::isDoubleExactEntry(const multitype* multi, 
                                           SgInitializedName* name, SgNode* sgNode) {
-  bool isCurrentValueContained=false;
-  multitype::const_iterator i = multi->begin();    
-  //SgNode* sgNodeMM = NULL;
-  for (; i != multi->end(); ++i) {
-    SgInitializedName* initNameMM = (*i).first;
-    SgNode* sgnodeMM = (*i).second;
-    if (initNameMM==name && sgnodeMM==sgNode)
-      isCurrentValueContained=true;
-    // cout << " comparing -  map: " << initNameMM << " vs. search: " << initName <<
-    //  "   result euqal? " << resBool(isCurrentValueContained) << endl;
-  } 
-  return isCurrentValueContained;
+  return binary_search(multi->begin(), multi->end(), make_pair(name, sgNode));
 }
 
 /**********************************************************
  *  Search for the value for a certain key in the multimap
  *********************************************************/
 bool DefUseAnalysisAbstract::searchMulti(const multitype* multi, SgInitializedName* initName) {
-  bool isCurrentValueContained=false;
-  multitype::const_iterator i = multi->begin();    
-  //SgNode* sgNodeMM = NULL;
-  for (; i != multi->end(); ++i) {
-    SgInitializedName* initNameMM = (*i).first;
-    if (initNameMM==initName)
-      isCurrentValueContained=true;
-    // cout << " comparing -  map: " << initNameMM << " vs. search: " << initName <<
-    //  "   result euqal? " << resBool(isCurrentValueContained) << endl;
-  } 
-  return isCurrentValueContained;
+  // the smallest possible entry of initName
+  multitype::const_iterator i = lower_bound(multi->begin(), multi->end(), make_pair(initName, (SgNode*)NULL));
+  return i != multi->end() && i->first == initName;
 }
 
 
@@ -69,24 +52,10 @@ bool DefUseAnalysisAbstract::searchMulti(const multitype* multi, SgInitializedNa
  *********************************************************/
 bool DefUseAnalysisAbstract::checkElementsForChange(const multitype* t1, const multitype* t2) {
   // if every element of t2 is contained in t1, then no change
-  // occurred in the map
-  
-  typedef set<pair<SgInitializedName*, SgNode*> > st;
-  st s1(t1->begin(), t1->end());
-  st s2(t2->begin(), t2->end());
-  assert (s1.size() == t1->size());
-
-  //  if (s2.size() != t2->size())
-  //    printMultiMap(t2);
-  if (s2.size() != t2->size())
-  {
-    cerr<<"s2.size()="<< s2.size() <<endl;
-    cerr<<"t2.size()="<< t2->size() <<endl;
-    dfa->printMultiMap (t2);
-    assert(s2.size() == t2->size());
-  }
-
-  return s1 != s2;
+  // occurred in the map. The entries of the DefUseAnalysis tables
+  // are sorted and free of duplicates, so the sets are equal
+  // exactly when the vectors are.
+  return *t1 != *t2;
   /*
 
 
@@ -15,7 +15,7 @@ using namespace std;
  *********************************************************/
 bool DefUseAnalysisPF::makeSureThatTheDefIsInTable(SgInitializedName* initName) {
   bool addedNode = false;
-  vector<pair<SgInitializedName*, SgNode*> > mymap = dfa->getDefMultiMapFor(
+  const vector<pair<SgInitializedName*, SgNode*> >& mymap = dfa->getDefMultiMapFor(
                                                                             initName);
   if (mymap.size() == 0) {
     dfa->addDefElement(initName, initName, initName);
@@ -36,7 +36,7 @@ bool DefUseAnalysisPF::makeSureThatTheDefIsInTable(SgInitializedName* initName)
  *********************************************************/
 bool DefUseAnalysisPF::makeSureThatTheUseIsInTable(SgInitializedName* initName) {
   bool addedNode = false;
-  vector<pair<SgInitializedName*, SgNode*> > mymap = dfa->getUseMultiMapFor(
+  const vector<pair<SgInitializedName*, SgNode*> >& mymap = dfa->getUseMultiMapFor(
                                                                             initName);
   if (mymap.size() == 0) {
     dfa->addUseElement(initName, initName, initName);
@@ -313,9 +313,8 @@ bool DefUseAnalysisPF::defuse(T cfgNode, bool *unhandled) {
   else if (isSgVarRefExp(sgNode)) {
     SgVarRefExp* varRefExp = isSgVarRefExp(sgNode);
     initName = varRefExp->get_symbol()->get_declaration();
-    string name = initName->get_qualified_name().str();
     if (DEBUG_MODE)
-      cout << " **********  VARREFEXP. " << varRefExp << " .. " << name << endl;
+      cout << " **********  VARREFEXP. " << varRefExp << " .. " << initName->get_qualified_name().str() << endl;
     //isUse=true;
     isDefinition=false;
     SgNode* parent = varRefExp->get_parent();
@@ -577,7 +576,7 @@ bool DefUseAnalysisPF::performUseAndDefinition(SgNode* sgNode,
          << " : " << initName->get_qualified_name().str() << endl;
   multitype oldTable = dfa->getDefMultiMapFor(sgNode);
   handleDefCopy(sgNode, cfgNode.inEdges().size(), sgNodeBefore, cfgNode);
-  multitype newTable = dfa->getDefMultiMapFor(sgNode);
+  const multitype& newTable = dfa->getDefMultiMapFor(sgNode);
   // did the copying change anything ?
   changedTableEntry = checkElementsForChange(&oldTable, &newTable);
 
@@ -592,7 +591,7 @@ bool DefUseAnalysisPF::performUseAndDefinition(SgNode* sgNode,
 
   if (isUsage) {
     // tracking the use table
-    multitype mmUse = dfa->getUseMultiMapFor(sgNode);
+    const multitype& mmUse = dfa->getUseMultiMapFor(sgNode);
     if (isDoubleExactEntry(&mmUse, initName, sgNode) == false)
       dfa->addUseElement(sgNode, initName, sgNode);
   }
@@ -603,7 +602,7 @@ bool DefUseAnalysisPF::performUseAndDefinition(SgNode* sgNode,
            << "  initName: " << initName->get_qualified_name().str()
            << endl;
     // check if global var is contained in this multimap, if not, we nned to add it
-    multitype mmap = dfa->getDefMultiMapFor(sgNode);
+    const multitype& mmap = dfa->getDefMultiMapFor(sgNode);
     bool isGlobalContainedinMM = searchMulti(&mmap, initName);
     bool isGlobalContainedinM = dfa->searchMap(initName);
     if (DEBUG_MODE) {
@@ -648,7 +647,7 @@ bool DefUseAnalysisPF::performUseAndDefinition(SgNode* sgNode,
     // and add conservatively all possible values
     if (isDefinition) {
       // the global variable is being overwritten
-      multitype mm = dfa->getDefMultiMapFor(initName);
+      const multitype& mm = dfa->getDefMultiMapFor(initName);
       if (isDoubleExactEntry(&mm, initName, sgNode) == false)
         dfa->addDefElement(initName, initName, sgNode);
     }
@@ -659,7 +658,7 @@ bool DefUseAnalysisPF::performUseAndDefinition(SgNode* sgNode,
     dfa->clearUseOfElement(sgNode, initName);
 
     bool isCurrentValueContained = false;
-    multitype mul = dfa->getDefMultiMapFor(initName);
+    const multitype& mul = dfa->getDefMultiMapFor(initName);
     //multitype mul = dfa->getDefUseFor(sgNode);
     if (mul.size() > 0) {
       isCurrentValueContained = searchMulti(&mul, initName);
@@ -743,13 +742,12 @@ bool DefUseAnalysisPF::performUseAndDefinition(SgNode* sgNode,
           if (isDoubleExactEntry(&mul, initName, sgNode)==false) {
           dfa->addElement(sgNode, initName, sgNode);
         */
-        multitype mm = dfa->getDefMultiMapFor(sgNode);
         if (dont_replace == true) {
-          if (isDoubleExactEntry(&mm, initName, sgNode) == false)
+          if (isDoubleExactEntry(&dfa->getDefMultiMapFor(sgNode), initName, sgNode) == false)
             dfa->addDefElement(sgNode, initName, sgNode);
         } else
           dfa->replaceElement(sgNode, initName);
-        mm = dfa->getDefMultiMapFor(sgNode);
+        const multitype& mm = dfa->getDefMultiMapFor(sgNode);
         /*/ ---
           cout << " !!!!!!!!!!!!!! newTable " << dfa->getIntForSgNode(sgNode) << endl;
           multitype mm2 = dfa->getDefUseFor(sgNode);
@@ -785,7 +783,7 @@ bool DefUseAnalysisPF::performUseAndDefinition(SgNode* sgNode,
         } else {
           dfa->replaceElement(sgNode, initName);
           //cout << ">>> replaceElement" << endl;
-          multitype mm = dfa->getDefMultiMapFor(sgNode);
+          const multitype& mm = dfa->getDefMultiMapFor(sgNode);
           changedTableEntry = checkElementsForChange(&oldTable,
                                                        &(mm));
         }
@@ -813,12 +811,11 @@ bool DefUseAnalysisPF::performUseAndDefinition(SgNode* sgNode,
  *********************************************************/
 void DefUseAnalysisPF::handleDefCopy(SgNode* sgNode, int nrOfInEdges,
                                      SgNode* sgNodeBefore, filteredCFGNodeType cfgNode) {
-  multitype oldTable = dfa->getDefMultiMapFor(sgNode);
   if (DEBUG_MODE) {
     cout<<"--------------------------------------"<<endl;  
     cout << " DEFMAP BEFORE UNION of OUT[pred]: " << endl;
     //dfa->printDefMap();
-    dfa->printMultiMap (&oldTable);
+    dfa->printMultiMap (dfa->getDefMultiMapFor(sgNode));
   }
   if (nrOfInEdges <= 1) {
     if (DEBUG_MODE)
@@ -846,7 +843,6 @@ void DefUseAnalysisPF::handleDefCopy(SgNode* sgNode, int nrOfInEdges,
  *********************************************************/
 void DefUseAnalysisPF::handleUseCopy(SgNode* sgNode, int nrOfInEdges,
                                      SgNode* sgNodeBefore, filteredCFGNodeType cfgNode) {
-  multitype oldTable = dfa->getUseMultiMapFor(sgNode);
   if (DEBUG_MODE) {
     cout<<"--------------------------------------"<<endl;  
     cout << " USEMAP BEFORE UNION of OUT[pred]: " << endl;
@@ -916,6 +912,11 @@ static void initList(
  *********************************************************/
 FilteredCFGNode<IsDFAFilter> DefUseAnalysisPF::run(
                                                    SgFunctionDefinition* funcDecl, bool& abortme) {
+  return run(funcDecl, getFullName(funcDecl), abortme);
+}
+
+FilteredCFGNode<IsDFAFilter> DefUseAnalysisPF::run(
+                                                   SgFunctionDefinition* funcDecl, const string& funcName, bool& abortme) {
   // filter functions -- to only functions in analyzed file
   nrOfNodesVisitedPF = 0;
   breakPointForWhileNode = NULL;
@@ -924,7 +925,6 @@ FilteredCFGNode<IsDFAFilter> DefUseAnalysisPF::run(
   doNotVisitMap.clear();
   nodeChangedMap.clear();
 
-  string funcName = getFullName(funcDecl);
   //  DEBUG_MODE = false;
   DEBUG_MODE_EXTRA = false;
   
@@ -1009,8 +1009,8 @@ FilteredCFGNode<IsDFAFilter> DefUseAnalysisPF::run(
     }
 #endif
     
-    multitype newDefTable = dfa->getDefMultiMapFor(next);
-    multitype newUseTable = dfa->getUseMultiMapFor(next);
+    const multitype& newDefTable = dfa->getDefMultiMapFor(next);
+    const multitype& newUseTable = dfa->getUseMultiMapFor(next);
     
     // Use the classic condition: if either def or use info. is changed?
     bool defChanged= checkElementsForChange(&oldDefTable, &newDefTable); 
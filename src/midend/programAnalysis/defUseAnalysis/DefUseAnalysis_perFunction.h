@@ -48,6 +48,8 @@ class DefUseAnalysisPF : public DefUseAnalysisAbstract {
   };
   virtual ~DefUseAnalysisPF(){};
   FilteredCFGNode < IsDFAFilter > run(SgFunctionDefinition* function, bool& abortme);
+  // the same, with the name of the function as computed by getFullName()
+  FilteredCFGNode < IsDFAFilter > run(SgFunctionDefinition* function, const std::string& funcName, bool& abortme);
   int getNumberOfNodesVisited();
 
 };
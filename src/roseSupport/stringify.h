@@ -2854,7 +2854,7 @@ namespace Rose {
 }
 
 // DO NOT EDIT -- This implementation was automatically generated for the enum defined at
-// /src/midend/BinaryAnalysis/BinaryMagic.h line 16
+// /src/midend/BinaryAnalysis/BinaryMagic.h line 23
 namespace stringify { namespace Rose { namespace BinaryAnalysis { namespace MagicNumber {
     /** Convert Rose::BinaryAnalysis::MagicNumber::Mechanism enum constant to a string. */
     const char* Mechanism(long);
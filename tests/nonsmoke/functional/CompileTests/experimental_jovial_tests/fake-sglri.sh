@@ -0,0 +1,14 @@
+#!/bin/sh
+# Stands in for sglri in testSglrParser: writes the name of the input file as a textual ATerm.
+# Inputs whose names contain "slow" take long enough to still be running when the test exits.
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -i) input="$2"; shift ;;
+        -o) output="$2"; shift ;;
+    esac
+    shift
+done
+case "$input" in
+    *slow*) sleep 5 ;;
+esac
+echo "file(\"$input\")" > "$output"
@@ -0,0 +1,25 @@
+! Modules with private entities, used by useModuleWithPrivateEntities.f90 (see testFortranModuleUse.C)
+module symtab_private_mod
+  implicit none
+  private :: helper
+  integer, private :: hidden_count = 0
+  integer :: visible_count = 0
+  public :: bump
+contains
+  subroutine bump()
+    call helper()
+    visible_count = visible_count + 1
+  end subroutine bump
+
+  subroutine helper()
+    hidden_count = hidden_count + 1
+  end subroutine helper
+end module symtab_private_mod
+
+module symtab_default_private_mod
+  implicit none
+  private
+  public :: exported_value
+  integer :: internal_value = 1
+  integer :: exported_value = 2
+end module symtab_default_private_mod
@@ -0,0 +1,8 @@
+! Uses the modules of moduleWithPrivateEntities.f90, which must precede this file on the command line
+subroutine use_private_modules()
+  use symtab_private_mod
+  use symtab_default_private_mod
+  implicit none
+  call bump()
+  visible_count = visible_count + exported_value
+end subroutine use_private_modules